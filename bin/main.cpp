@@ -4,17 +4,21 @@
 #include <numeric>
 
 struct Options {
-    bool& sum;
-    bool& mult;
+    std::vector<float> values;
+    bool sum = false;
+    bool mult = false;
 };
 
 int main(int argc, char** argv) {
     ArgumentParser::ArgParser parser("Program");
 
-    std::vector<float>& values = parser.AddArgument<float, 1>("N").Positional().GetStorage();
+    Options opt;
 
-    Options opt{parser.AddFlag("sum", "add args").GetStorage(),
-                parser.AddFlag("mult", "multiply args").GetStorage()};
+    parser.Bind<1>(opt, &Options::values, "N").Positional();
+    parser.Bind(opt, &Options::sum, "sum", "add args");
+    parser.Bind(opt, &Options::mult, "mult", "multiply args");
+    parser.MutuallyExclusive({"sum", "mult"});
+    parser.AtLeastOneOf({"sum", "mult"});
 
     parser.AddHelp("Program accumulate arguments");
 
@@ -30,14 +34,10 @@ int main(int argc, char** argv) {
     }
 
     if (opt.sum) {
-        std::cout << "Result: " << std::accumulate(values.begin(), values.end(), 0.0) << std::endl;
-    } else if (opt.mult) {
-        std::cout << "Result: " << std::accumulate(values.begin(), values.end(), 1, std::multiplies<int>())
-                  << std::endl;
+        std::cout << "Result: " << std::accumulate(opt.values.begin(), opt.values.end(), 0.0) << std::endl;
     } else {
-        std::cout << "No one options had chosen" << std::endl;
-        std::cout << parser.HelpDescription();
-        return 1;
+        std::cout << "Result: " << std::accumulate(opt.values.begin(), opt.values.end(), 1, std::multiplies<int>())
+                  << std::endl;
     }
 
     return 0;
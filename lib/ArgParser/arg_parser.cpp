@@ -1,4 +1,5 @@
 #include "arg_parser.h"
+#include "token.h"
 
 #include <iostream>
 #include <sstream>
@@ -27,8 +28,8 @@ std::string ArgParser::HelpDescription() const {
     }
     ss << '\n';
 
-    if (!argument_map_.empty()) {
-        for (const auto& [name, arg] : argument_map_) {
+    if (!arguments_.empty()) {
+        for (const auto& arg : arguments_) {
             ss << *arg << '\n';
         }
         ss << '\n';
@@ -65,84 +66,311 @@ bool ArgParser::GetFlagValue(char short_name) {
     return GetArgumentValue<bool>(short_name);
 }
 
+std::string_view ArgParser::GetArgumentView(const std::string& long_name) {
+    auto iter = argument_map_.find(long_name);
+
+    if (iter != argument_map_.end() && iter->second->GetType() == typeid(std::string_view)) {
+        return GetArgumentRef<std::string_view>(long_name);
+    }
+
+    return GetArgumentRef<std::string>(long_name);
+}
+
 bool ArgParser::Parse(const std::vector<std::string>& vec) {
+    bool options_ended = false;
+    present_.assign((arguments_.size() + 63) / 64, 0);
+
     for (auto str = vec.begin() + 1; str != vec.end(); ++str) {
-        if (str->starts_with("--")) {
-            auto border = str->find('=');
-            std::string long_name = str->substr(2, border - 2);
-            std::string value = str->substr(border + 1);
+        size_t border = std::string_view::npos;
+        const TokenKind kind = options_ended ? TokenKind::Positional : ClassifyToken(*str, border);
 
-            auto iter = argument_map_.find(long_name);
+        switch (kind) {
+            case TokenKind::Separator:
+                options_ended = true;
+                break;
 
-            if (iter == argument_map_.end()) {
-                PrintError(UnknownArgument, long_name);
-            }
+            case TokenKind::Long:
+            case TokenKind::LongWithValue: {
+                const std::string_view token = *str;
+                const std::string_view long_name = token.substr(2, border - 2);
 
-            ArgumentBase* argument = iter->second.get();
+                auto iter = argument_map_.find(long_name);
 
-            if (border == std::string::npos) {
-                if (argument->GetType() == typeid(bool)) {
-                    argument->SetValueFromString("1");
-                    continue;
+                if (iter == argument_map_.end()) {
+                    PrintError(UnknownArgument, std::string(long_name));
                 }
-                argument->PrintError(NoArgumentValue);
-            }
-
-            if (argument->GetType() != typeid(bool) && value.empty()) {
-                argument->PrintError(NoArgumentValue);
-            }
 
-            argument->SetValueFromString(value);
+                ArgumentBase* argument = iter->second;
 
-        } else if (str->starts_with("-")) {
-            for (int i = 1; i < str->length(); ++i) {
-                char c = (*str)[i];
+                if (kind == TokenKind::Long) {
+                    if (argument->GetType() == typeid(bool)) {
+                        argument->SetValueFromString("1");
+                        MarkPresent(argument);
+                        break;
+                    }
+                    argument->PrintError(NoArgumentValue);
+                }
 
-                auto iter_name = long_name_map_.find(c);
+                const std::string_view value = token.substr(border + 1);
 
-                if (iter_name == long_name_map_.end()) {
-                    PrintError(UnknownArgument, c);
+                if (argument->GetType() != typeid(bool) && value.empty()) {
+                    argument->PrintError(NoArgumentValue);
                 }
 
-                auto iter_arg = argument_map_.find(iter_name->second);
+                Assign(argument, value);
+                break;
+            }
 
-                ArgumentBase* argument = iter_arg->second.get();
+            case TokenKind::ShortCluster:
+                ParseShortCluster(str, vec.end());
+                break;
 
-                if (argument->GetType() == typeid(bool)) {
-                    argument->SetValueFromString("1");
-                } else {
-                    if (i != str->length() - 1) {
-                        PrintError(UnknownArgument, *str);
-                    }
-                    if (++str == vec.end()) {
-                        argument->PrintError(NoArgumentValue);
-                    }
-                    argument->SetValueFromString(*str);
-                    break;
+            case TokenKind::Positional:
+                if (FindPositional() == nullptr) {
+                    PrintError(NoPositionalArgument, *str);
                 }
+
+                Assign(positional_argument_, *str);
+                break;
+        }
+    }
+
+    // A help request is answered even if the rest of the command line breaks a constraint
+    if (!constraints_.Empty() && !Help()) {
+        const std::vector<std::string> violations = constraints_.Check(present_, arguments_);
+        for (const std::string& violation : violations) {
+            std::cerr << "error: " << violation << std::endl;
+        }
+        if (!violations.empty()) {
+            return false;
+        }
+    }
+
+    return std::all_of(arguments_.cbegin(), arguments_.cend(),
+                       [](const auto& arg) {
+                           return arg->HasValue();
+                       });
+}
+
+ArgumentBase* ArgParser::FindPositional() {
+    if (!positional_argument_) {
+        for (const auto& arg : arguments_) {
+            if (arg->IsPositional()) {
+                positional_argument_ = arg.get();
+                break;
             }
+        }
+    }
+
+    return positional_argument_;
+}
+
+ArgumentBase* ArgParser::FindArgument(std::string_view long_name, const std::type_info& type, bool multivalued) {
+    auto iter = argument_map_.find(long_name);
+
+    if (iter == argument_map_.end()) {
+        PrintError(UnknownArgument, std::string(long_name));
+    }
 
+    ArgumentBase* argument = iter->second;
+
+    if (argument->GetType() != type || argument->IsMultivalued() != multivalued) {
+        argument->PrintError(InvalidArgumentType);
+    }
+
+    return argument;
+}
+
+ArgumentBase* ArgParser::FindArgument(char short_name, const std::type_info& type, bool multivalued) {
+    ArgumentBase* argument = short_arguments_[static_cast<unsigned char>(short_name)];
+
+    if (argument == nullptr) {
+        PrintError(UnknownArgument, short_name);
+    }
+
+    if (argument->GetType() != type || argument->IsMultivalued() != multivalued) {
+        argument->PrintError(InvalidArgumentType);
+    }
+
+    return argument;
+}
+
+void ArgParser::ParseShortCluster(std::vector<std::string>::const_iterator& str,
+                                  std::vector<std::string>::const_iterator end) {
+    const std::string_view cluster = std::string_view(*str).substr(1);
+
+    // Clusters made only of flags, like -abc, are detected by AND-ing their bits in the flag mask, which has
+    // no data-dependent branch, and then set in a second pass
+    bool only_flags = true;
+    for (char c : cluster) {
+        only_flags &= short_flags_[static_cast<unsigned char>(c)];
+    }
+
+    if (only_flags) {
+        for (char c : cluster) {
+            ArgumentBase* argument = short_arguments_[static_cast<unsigned char>(c)];
+            argument->SetValueFromString("1");
+            MarkPresent(argument);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < cluster.size(); ++i) {
+        const char c = cluster[i];
+
+        ArgumentBase* argument = short_arguments_[static_cast<unsigned char>(c)];
+
+        if (argument == nullptr) {
+            PrintError(UnknownArgument, c);
+        }
+
+        if (argument->GetType() == typeid(bool)) {
+            argument->SetValueFromString("1");
+            MarkPresent(argument);
         } else {
-            if (!positional_argument_) {
-                for (const auto& [long_name, arg] : argument_map_) {
-                    if (arg->IsPositional()) {
-                        positional_argument_ = arg.get();
-                        break;
-                    }
-                }
-                if (!positional_argument_) {
-                    PrintError(NoPositionalArgument, *str);
-                }
+            if (i != cluster.size() - 1) {
+                PrintError(UnknownArgument, *str);
+            }
+            if (++str == end) {
+                argument->PrintError(NoArgumentValue);
             }
+            Assign(argument, *str);
+            break;
+        }
+    }
+}
+
+void ArgParser::MarkPresent(const ArgumentBase* argument) {
+    present_[argument->index_ / 64] |= uint64_t{1} << (argument->index_ % 64);
+}
+
+size_t ArgParser::IndexOf(std::string_view long_name) {
+    auto iter = argument_map_.find(long_name);
+
+    if (iter == argument_map_.end()) {
+        PrintError(UnknownArgument, std::string(long_name));
+    }
+
+    return iter->second->index_;
+}
+
+std::vector<size_t> ArgParser::IndicesOf(std::initializer_list<std::string_view> long_names) {
+    std::vector<size_t> indices;
+    indices.reserve(long_names.size());
+    for (std::string_view long_name : long_names) {
+        indices.push_back(IndexOf(long_name));
+    }
+
+    return indices;
+}
+
+void ArgParser::Required(const std::string& long_name) {
+    constraints_.Add(ConstraintKind::Required, IndexOf(long_name), {});
+}
+
+void ArgParser::MutuallyExclusive(std::initializer_list<std::string_view> long_names) {
+    constraints_.Add(ConstraintKind::MutuallyExclusive, 0, IndicesOf(long_names));
+}
+
+void ArgParser::AtLeastOneOf(std::initializer_list<std::string_view> long_names) {
+    constraints_.Add(ConstraintKind::AtLeastOneOf, 0, IndicesOf(long_names));
+}
 
-            positional_argument_->SetValueFromString(*str);
+void ArgParser::Requires(const std::string& long_name, std::initializer_list<std::string_view> required) {
+    constraints_.Add(ConstraintKind::Requires, IndexOf(long_name), IndicesOf(required));
+}
+
+void ArgParser::ConflictsWith(const std::string& long_name, std::initializer_list<std::string_view> conflicting) {
+    constraints_.Add(ConstraintKind::ConflictsWith, IndexOf(long_name), IndicesOf(conflicting));
+}
+
+void ArgParser::SetLazy(bool lazy) {
+    lazy_ = lazy;
+}
+
+void ArgParser::Assign(ArgumentBase* argument, std::string_view value) {
+    MarkPresent(argument);
+
+    if (lazy_ && !argument->is_eager_) {
+        argument->pending_values_.push_back(pending_strings_.Add(value));
+    } else {
+        argument->SetValueFromString(value);
+    }
+}
+
+void ArgParser::AddArguments(std::span<const OptionSpec> specs) {
+    arguments_.reserve(arguments_.size() + specs.size());
+    argument_map_.reserve(argument_map_.size() + specs.size());
+
+    for (const OptionSpec& spec : specs) {
+        switch (spec.type) {
+            case OptionType::Flag:
+                Register(MakeArgument<bool>(spec));
+                break;
+            case OptionType::Int:
+                Register(MakeArgument<int>(spec));
+                break;
+            case OptionType::Float:
+                Register(MakeArgument<float>(spec));
+                break;
+            case OptionType::String:
+                Register(MakeArgument<std::string>(spec));
+                break;
         }
     }
+}
 
-    return std::all_of(argument_map_.cbegin(), argument_map_.cend(),
-                       [](const auto& pair) {
-                           return pair.second->HasValue();
-                       });
+template<typename T>
+std::unique_ptr<ArgumentBase> ArgParser::MakeArgument(const OptionSpec& spec) {
+    const std::string_view long_name = strings_.Add(spec.long_name);
+    const std::string_view description = strings_.Add(spec.description);
+
+    std::unique_ptr<ArgumentBase> argument;
+    if (spec.multivalued) {
+        auto multivalued = spec.short_name != '\0'
+                           ? std::make_unique<Argument<T, true>>(spec.short_name, long_name, spec.min_size, description)
+                           : std::make_unique<Argument<T, true>>(long_name, spec.min_size, description);
+        multivalued->Delimiter(spec.delimiter);
+        argument = std::move(multivalued);
+    } else {
+        argument = spec.short_name != '\0'
+                   ? std::make_unique<Argument<T>>(spec.short_name, long_name, description)
+                   : std::make_unique<Argument<T>>(long_name, description);
+    }
+
+    argument->is_positional_ = spec.positional;
+
+    if (!spec.default_value.empty()) {
+        argument->SetDefaultFromString(spec.default_value);
+    } else if (spec.type == OptionType::Flag) {
+        argument->SetDefaultFromString("0");
+    }
+
+    return argument;
+}
+
+ArgumentBase& ArgParser::Register(std::unique_ptr<ArgumentBase> argument) {
+    ArgumentBase* arg = argument.get();
+
+    if (arg->short_name_.has_value() && short_arguments_[static_cast<unsigned char>(*arg->short_name_)] != nullptr) {
+        PrintError(ArgumentAlreadyExists, arg->short_name_.value());
+    }
+
+    if (!argument_map_.emplace(arg->long_name_, arg).second) {
+        PrintError(ArgumentAlreadyExists, arg->GetLongName());
+    }
+
+    arg->index_ = arguments_.size();
+    arguments_.push_back(std::move(argument));
+    layout_hash_ = HashArgument(layout_hash_, *arg);
+
+    if (arg->short_name_.has_value()) {
+        const auto short_name = static_cast<unsigned char>(arg->short_name_.value());
+        short_arguments_[short_name] = arg;
+        short_flags_.set(short_name, arg->GetType() == typeid(bool));
+    }
+
+    return *arg;
 }
 
 bool ArgParser::Parse(int argc, char** argv) {
@@ -177,6 +405,9 @@ void ArgParser::PrintError(const ArgParserError& error, const std::string& long_
         case NoPositionalArgument:
             std::cerr << "no positional argument for the value " << long_name << std::endl;
             break;
+        case MissingArgumentValue:
+            std::cerr << "no value was passed for the argument --" << long_name << std::endl;
+            break;
         default:
             std::cerr << "unknown error" << std::endl;
     }
@@ -1,9 +1,16 @@
 #pragma once
 
 #include "argument.h"
+#include "constraints.h"
+#include "string_table.h"
 
+#include <array>
+#include <bitset>
+#include <initializer_list>
 #include <unordered_map>
 #include <memory>
+#include <span>
+#include <string_view>
 
 namespace ArgumentParser {
 
@@ -12,8 +19,35 @@ enum ArgParserError {
     HelpArgumentAlreadyExists,
     UnknownArgument,
     NoPositionalArgument,
+    MissingArgumentValue,
 };
 
+enum class OptionType {
+    Flag,
+    Int,
+    Float,
+    String,
+};
+
+// Static description of one argument for ArgParser::AddArguments, default_value is parsed like a command line value
+struct OptionSpec {
+    char short_name = '\0';
+    std::string_view long_name{};
+    std::string_view description{};
+    OptionType type = OptionType::String;
+    std::string_view default_value{};
+    bool positional = false;
+    bool multivalued = false;
+    size_t min_size = 0;
+    char delimiter = '\0';
+};
+
+template<typename T>
+constexpr bool kIsVector = false;
+
+template<typename T>
+constexpr bool kIsVector<std::vector<T>> = true;
+
 class ArgParser {
   public:
     explicit ArgParser(std::string name);
@@ -26,32 +60,16 @@ class ArgParser {
 
     template<typename T>
     Argument<T>& AddArgument(const std::string& long_name, const std::string& description = "") {
-        auto argument = std::make_unique<Argument<T>>(long_name, description);
-        auto [it, inserted] = argument_map_.emplace(long_name, std::move(argument));
+        auto argument = std::make_unique<Argument<T>>(strings_.Add(long_name), strings_.Add(description));
 
-        if (!inserted) {
-            PrintError(ArgumentAlreadyExists, long_name);
-        }
-
-        return *dynamic_cast<Argument<T>*>(it->second.get());
+        return static_cast<Argument<T>&>(Register(std::move(argument)));
     }
 
     template<typename T>
     Argument<T>& AddArgument(char short_name, const std::string& long_name, const std::string& description = "") {
-        auto [it_name, inserted_name] = long_name_map_.emplace(short_name, long_name);
-
-        if (!inserted_name) {
-            PrintError(ArgumentAlreadyExists, short_name);
-        }
-
-        auto argument = std::make_unique<Argument<T>>(short_name, long_name, description);
-        auto [it_arg, inserted_arg] = argument_map_.emplace(long_name, std::move(argument));
+        auto argument = std::make_unique<Argument<T>>(short_name, strings_.Add(long_name), strings_.Add(description));
 
-        if (!inserted_arg) {
-            PrintError(ArgumentAlreadyExists, long_name);
-        }
-
-        return *dynamic_cast<Argument<T>*>(it_arg->second.get());
+        return static_cast<Argument<T>&>(Register(std::move(argument)));
     }
 
     Argument<bool>& AddFlag(const std::string& long_name, const std::string& description = "");
@@ -60,74 +78,89 @@ class ArgParser {
 
     template<typename T, size_t min_size>
     Argument<T, true>& AddArgument(const std::string& long_name, const std::string& description = "") {
-        auto argument = std::make_unique<Argument<T, true>>(long_name, min_size, description);
-        auto [it, inserted] = argument_map_.emplace(long_name, std::move(argument));
+        auto argument = std::make_unique<Argument<T, true>>(strings_.Add(long_name), min_size,
+                                                            strings_.Add(description));
 
-        if (!inserted) {
-            PrintError(ArgumentAlreadyExists, long_name);
-        }
-
-        return *dynamic_cast<Argument<T, true>*>(it->second.get());
+        return static_cast<Argument<T, true>&>(Register(std::move(argument)));
     }
 
     template<typename T, size_t min_size>
     Argument<T, true>& AddArgument(char short_name, const std::string& long_name, const std::string& description = "") {
-        auto [it_name, inserted_name] = long_name_map_.emplace(short_name, long_name);
-
-        if (!inserted_name) {
-            PrintError(ArgumentAlreadyExists, short_name);
-        }
+        auto argument = std::make_unique<Argument<T, true>>(short_name, strings_.Add(long_name), min_size,
+                                                            strings_.Add(description));
 
-        auto argument = std::make_unique<Argument<T, true>>(short_name, long_name, min_size, description);
-        auto [it_arg, inserted_arg] = argument_map_.emplace(long_name, std::move(argument));
+        return static_cast<Argument<T, true>&>(Register(std::move(argument)));
+    }
 
-        if (!inserted_arg) {
-            PrintError(ArgumentAlreadyExists, long_name);
-        }
+    // Registers a whole table of arguments at once, the lookup tables are grown a single time
+    void AddArguments(std::span<const OptionSpec> specs);
 
-        return *dynamic_cast<Argument<T, true>*>(it_arg->second.get());
+    template<typename S, typename T>
+    Argument<T>& Bind(S& target, T S::* field, const std::string& long_name, const std::string& description = "") {
+        return AddArgument<T>(long_name, description).Bind(target.*field);
     }
 
-    template<typename T>
-    T GetArgumentValue(const std::string& long_name) {
-        auto iter = argument_map_.find(long_name);
-
-        if (iter == argument_map_.end()) {
-            PrintError(UnknownArgument, long_name);
-        }
+    template<typename S, typename T>
+    Argument<T>& Bind(S& target, T S::* field, char short_name, const std::string& long_name,
+                      const std::string& description = "") {
+        return AddArgument<T>(short_name, long_name, description).Bind(target.*field);
+    }
 
-        ArgumentBase* argument = iter->second.get();
+    template<size_t min_size, typename S, typename T>
+    Argument<T, true>& Bind(S& target, std::vector<T> S::* field, const std::string& long_name,
+                            const std::string& description = "") {
+        return AddArgument<T, min_size>(long_name, description).Bind(target.*field);
+    }
 
-        if (argument->GetType() != typeid(T)) {
-            argument->PrintError(InvalidArgumentType);
-        }
+    template<size_t min_size, typename S, typename T>
+    Argument<T, true>& Bind(S& target, std::vector<T> S::* field, char short_name, const std::string& long_name,
+                            const std::string& description = "") {
+        return AddArgument<T, min_size>(short_name, long_name, description).Bind(target.*field);
+    }
 
-        return dynamic_cast<Argument<T>*>(argument)->GetValue();
+    template<typename T>
+    T GetArgumentValue(const std::string& long_name) {
+        return Find<T>(long_name).GetValue();
     }
 
     template<typename T>
     T GetArgumentValue(char short_name) {
-        auto iter_short = long_name_map_.find(short_name);
+        return Find<T>(short_name).GetValue();
+    }
 
-        if (iter_short == long_name_map_.end()) {
-            PrintError(UnknownArgument, short_name);
-        }
+    // Same as GetArgumentValue without the copy, the reference is valid until the next Parse
+    template<typename T>
+    const T& GetArgumentRef(const std::string& long_name) {
+        return Find<T>(long_name).GetValueRef();
+    }
 
-        const std::string long_name = iter_short->second;
+    template<typename T>
+    const T& GetArgumentRef(char short_name) {
+        return Find<T>(short_name).GetValueRef();
+    }
 
-        const auto iter_arg = argument_map_.find(long_name);
+    // Value of a std::string or std::string_view argument
+    std::string_view GetArgumentView(const std::string& long_name);
 
-        if (iter_arg == argument_map_.end()) {
-            PrintError(UnknownArgument, long_name);
-        }
+    // All values of a multivalued argument, valid until the next Parse
+    template<typename T>
+    std::span<const T> GetArgumentValues(const std::string& long_name) {
+        return Find<T, true>(long_name).GetValues();
+    }
 
-        ArgumentBase* argument = iter_arg->second.get();
+    template<typename T>
+    std::span<const T> GetArgumentValues(char short_name) {
+        return Find<T, true>(short_name).GetValues();
+    }
 
-        if (argument->GetType() != typeid(T)) {
-            argument->PrintError(InvalidArgumentType);
+    // Moves the value out of the parser, Take<std::vector<T>> takes all values of a multivalued argument
+    template<typename T>
+    T Take(const std::string& long_name) {
+        if constexpr (kIsVector<T>) {
+            return Find<typename T::value_type, true>(long_name).TakeValues();
+        } else {
+            return Find<T>(long_name).TakeValue();
         }
-
-        return dynamic_cast<Argument<T>*>(argument)->GetValue();
     }
 
     bool GetFlagValue(const std::string& long_name);
@@ -136,51 +169,93 @@ class ArgParser {
 
     template<typename T>
     T GetArgumentValue(const std::string& long_name, size_t index) {
-        auto iter = argument_map_.find(long_name);
-
-        if (iter == argument_map_.end()) {
-            PrintError(UnknownArgument, long_name);
-        }
-
-        ArgumentBase* argument = iter->second.get();
-
-        if (argument->GetType() != typeid(T)) {
-            argument->PrintError(InvalidArgumentType);
-        }
-
-        return dynamic_cast<Argument<T, true>*>(argument)->GetValue(index);
+        return Find<T, true>(long_name).GetValue(index);
     }
 
     template<typename T>
     T GetArgumentValue(char short_name, size_t index) {
-        auto iter_short = long_name_map_.find(short_name);
-
-        if (iter_short == long_name_map_.end()) {
-            PrintError(UnknownArgument, short_name);
-        }
+        return Find<T, true>(short_name).GetValue(index);
+    }
 
-        const std::string long_name = iter_short->second;
+    // Constraints on the arguments given on the command line, a default value does not count as given.
+    // Parse checks them all after the last token and reports every violation before returning false, unless help
+    // was requested
+    void Required(const std::string& long_name);
 
-        const auto iter_arg = argument_map_.find(long_name);
+    void MutuallyExclusive(std::initializer_list<std::string_view> long_names);
 
-        if (iter_arg == argument_map_.end()) {
-            PrintError(UnknownArgument, long_name);
-        }
+    void AtLeastOneOf(std::initializer_list<std::string_view> long_names);
 
-        ArgumentBase* argument = iter_arg->second.get();
+    void Requires(const std::string& long_name, std::initializer_list<std::string_view> required);
 
-        if (argument->GetType() != typeid(T)) {
-            argument->PrintError(InvalidArgumentType);
-        }
+    void ConflictsWith(const std::string& long_name, std::initializer_list<std::string_view> conflicting);
 
-        return dynamic_cast<Argument<T, true>*>(argument)->GetValue(index);
-    }
+    // In lazy mode Parse only stores the raw values, which are converted on the first access to each argument,
+    // so conversion errors are reported at that point. Arguments marked Eager() are still checked by Parse
+    void SetLazy(bool lazy = true);
 
     bool Parse(const std::vector<std::string>& vec);
 
     bool Parse(int argc, char** argv);
 
+    // Serializes the parsed values into a versioned blob tied to the current schema
+    [[nodiscard]] std::string Snapshot() const;
+
+    // Restores values saved by Snapshot, returns false if the blob is malformed or the schema differs
+    bool LoadSnapshot(std::string_view blob);
+
+    bool WriteSnapshot(int fd) const;
+
+    // Maps the snapshot stored in fd (a file or a memfd) read-only and loads it
+    bool ReadSnapshot(int fd);
+
   private:
+    friend class ParseEvent;
+    friend class ParseEvents;
+    friend class LiveConfig;
+    friend class ParseCache;
+
+    ArgumentBase& Register(std::unique_ptr<ArgumentBase> argument);
+
+    void Assign(ArgumentBase* argument, std::string_view value);
+
+    ArgumentBase* FindPositional();
+
+    size_t IndexOf(std::string_view long_name);
+
+    std::vector<size_t> IndicesOf(std::initializer_list<std::string_view> long_names);
+
+    void MarkPresent(const ArgumentBase* argument);
+
+    ArgumentBase* FindArgument(std::string_view long_name, const std::type_info& type, bool multivalued);
+
+    ArgumentBase* FindArgument(char short_name, const std::type_info& type, bool multivalued);
+
+    template<typename T, bool is_multivalued = false>
+    Argument<T, is_multivalued>& Find(const std::string& long_name) {
+        return static_cast<Argument<T, is_multivalued>&>(*FindArgument(long_name, typeid(T), is_multivalued));
+    }
+
+    template<typename T, bool is_multivalued = false>
+    Argument<T, is_multivalued>& Find(char short_name) {
+        return static_cast<Argument<T, is_multivalued>&>(*FindArgument(short_name, typeid(T), is_multivalued));
+    }
+
+    template<typename T>
+    std::unique_ptr<ArgumentBase> MakeArgument(const OptionSpec& spec);
+
+    void ParseShortCluster(std::vector<std::string>::const_iterator& str, std::vector<std::string>::const_iterator end);
+
+    [[nodiscard]] std::vector<ArgumentBase*> SortedArguments() const;
+
+    [[nodiscard]] uint64_t SchemaHash() const;
+
+    static uint64_t HashArgument(uint64_t hash, const ArgumentBase& argument);
+
+    // Hash of everything that decides how Parse turns tokens into values: the layout, the argument settings,
+    // lazy mode and the constraints
+    [[nodiscard]] uint64_t ParseHash() const;
+
     static void PrintError(const ArgParserError& error);
 
     static void PrintError(const ArgParserError& error, const std::string& long_name);
@@ -190,11 +265,27 @@ class ArgParser {
     const std::string name_;
     std::string description_;
 
+    bool lazy_ = false;
+    // Copies of the values kept by a lazy Parse
+    StringTable pending_strings_;
+
     Argument<bool>* help_argument_ = nullptr;
     ArgumentBase* positional_argument_ = nullptr;
 
-    std::unordered_map<std::string, std::unique_ptr<ArgumentBase>> argument_map_;
-    std::unordered_map<char, std::string> long_name_map_;
+    // Names and descriptions of all arguments, the views in arguments_ and argument_map_ point here
+    StringTable strings_;
+
+    // Arguments in registration order
+    std::vector<std::unique_ptr<ArgumentBase>> arguments_;
+    std::unordered_map<std::string_view, ArgumentBase*> argument_map_;
+    std::array<ArgumentBase*, 256> short_arguments_{};
+    std::bitset<256> short_flags_;
+    // Hash of the schema in registration order, updated by Register
+    uint64_t layout_hash_ = 14695981039346656037ull;
+
+    Constraints constraints_;
+    // Arguments seen by the last Parse
+    ArgumentMask present_;
 };
 
 } // ArgumentParser
@@ -2,15 +2,15 @@
 
 using namespace ArgumentParser;
 
-ArgumentBase::ArgumentBase(std::string long_name, std::string description)
-        : long_name_(std::move(long_name)), description_(std::move(description)) {
+ArgumentBase::ArgumentBase(std::string_view long_name, std::string_view description)
+        : long_name_(long_name), description_(description) {
     if (long_name_.empty()) {
         PrintError(EmptyArgumentLongName);
     }
 }
 
-ArgumentBase::ArgumentBase(char short_name, std::string long_name, std::string description)
-        : short_name_(short_name), long_name_(std::move(long_name)), description_(std::move(description)) {
+ArgumentBase::ArgumentBase(char short_name, std::string_view long_name, std::string_view description)
+        : long_name_(long_name), description_(description), short_name_(short_name) {
     if (short_name_.value() == ' ') {
         PrintError(EmptyArgumentShortName);
     }
@@ -20,7 +20,7 @@ ArgumentBase::ArgumentBase(char short_name, std::string long_name, std::string d
 }
 
 std::string ArgumentBase::GetLongName() const {
-    return long_name_;
+    return std::string(long_name_);
 }
 
 std::string ArgumentBase::GetTypeName() const {
@@ -31,7 +31,7 @@ std::string ArgumentBase::GetTypeName() const {
     if (type == typeid(int)) {
         return "int";
     }
-    if (type == typeid(std::string)) {
+    if (type == typeid(std::string) || type == typeid(std::string_view)) {
         return "string";
     }
     return type.name();
@@ -41,6 +41,21 @@ bool ArgumentBase::IsPositional() const {
     return is_positional_;
 }
 
+void ArgumentBase::ResolvePending() const {
+    if (pending_values_.empty()) {
+        return;
+    }
+
+    // Arguments are always created as non-const objects by the parser, so the conversion cache can be filled here
+    auto* self = const_cast<ArgumentBase*>(this);
+    const std::vector<std::string_view> pending = std::move(self->pending_values_);
+    self->pending_values_.clear();
+
+    for (std::string_view value : pending) {
+        self->SetValueFromString(value);
+    }
+}
+
 void ArgumentBase::PrintError(const ArgumentError& error) const {
     std::cerr << "error: ";
     switch (error) {
@@ -56,6 +71,9 @@ void ArgumentBase::PrintError(const ArgumentError& error) const {
         case InvalidArgumentType:
             std::cerr << "argument --" << GetLongName() << " has value type <" << GetTypeName() << ">" << std::endl;
             break;
+        case InvalidArgumentChoice:
+            std::cerr << "argument --" << GetLongName() << " must be one of <" << ChoicesString() << ">" << std::endl;
+            break;
         default:
             std::cerr << "unknown error" << std::endl;
     }
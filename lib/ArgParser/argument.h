@@ -1,32 +1,49 @@
 #pragma once
 
+#include "choice_table.h"
+#include "snapshot.h"
+#include "string_table.h"
+
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 #include <sstream>
+#include <string_view>
+#include <variant>
 #include <vector>
 #include <optional>
+#include <span>
 
 namespace ArgumentParser {
 
 class ArgParser;
 
+class ParseEvent;
+
+class ParseEvents;
+
 enum ArgumentError {
     EmptyArgumentLongName,
     EmptyArgumentShortName,
     NoArgumentValue,
     InvalidArgumentType,
+    InvalidArgumentChoice,
 };
 
 class ArgumentBase {
   public:
-    explicit ArgumentBase(std::string long_name, std::string description = "");
+    // Names and description are not copied, the parser keeps them in its string table
+    explicit ArgumentBase(std::string_view long_name, std::string_view description = "");
 
-    explicit ArgumentBase(char short_name, std::string long_name, std::string description = "");
+    explicit ArgumentBase(char short_name, std::string_view long_name, std::string_view description = "");
 
     virtual ~ArgumentBase() = default;
 
     [[nodiscard]] std::string GetLongName() const;
 
-    virtual void SetValueFromString(const std::string& value) = 0;
+    virtual void SetValueFromString(std::string_view value) = 0;
+
+    virtual void SetDefaultFromString(std::string_view value) = 0;
 
     [[nodiscard]] virtual bool HasValue() const = 0;
 
@@ -45,7 +62,9 @@ class ArgumentBase {
             os << "     ";
         }
         os << "--" << arg.long_name_;
-        if (arg.GetType() != typeid(bool)) {
+        if (arg.HasChoices()) {
+            os << "=<" << arg.ChoicesString() << ">";
+        } else if (arg.GetType() != typeid(bool)) {
             os << "=<" << arg.GetTypeName() << ">";
         }
         if (!arg.description_.empty()) {
@@ -79,6 +98,14 @@ class ArgumentBase {
 
     friend ArgParser;
 
+    friend ParseEvent;
+
+    friend ParseEvents;
+
+    friend class LiveConfig;
+
+    friend class ParseCache;
+
   protected:
     [[nodiscard]] virtual bool HasDefaultValue() const = 0;
 
@@ -86,67 +113,253 @@ class ArgumentBase {
 
     [[nodiscard]] virtual std::string DefaultValueString() const = 0;
 
+    [[nodiscard]] virtual bool HasChoices() const = 0;
+
+    [[nodiscard]] virtual std::string ChoicesString() const = 0;
+
+    [[nodiscard]] virtual const void* ChoicesTable() const = 0;
+
+    virtual void SaveValue(SnapshotWriter& writer) const = 0;
+
+    // Replaces the current value with the one saved by SaveValue
+    virtual bool LoadValue(SnapshotReader& reader) = 0;
+
+    // Checks that one value converts to the argument type and is an allowed choice, without storing it
+    [[nodiscard]] virtual bool IsValidValue(std::string_view value) const = 0;
+
+    // Reads past a value saved by SaveValue without storing it, used to check a snapshot before loading it
+    virtual bool SkipValue(SnapshotReader& reader) const = 0;
+
+    template<typename T>
+    void ConvertFromString(std::string_view str, const ChoiceView<T>& choices, T& value) const {
+        if (!TryConvertFromString(str, choices, value)) {
+            PrintError(choices ? InvalidArgumentChoice : InvalidArgumentType);
+        }
+    }
+
+    // Same as ConvertFromString, but returns false instead of stopping the program
+    template<typename T>
+    bool TryConvertFromString(std::string_view str, const ChoiceView<T>& choices, T& value) const {
+        // Enumerations have no operator>> and can only be read through Choices
+        static_assert(std::is_enum_v<T> || std::is_same_v<T, std::string_view>
+                      || requires(std::istream& stream) { stream >> value; },
+                      "argument type must be readable with operator>>");
+
+        if (choices) {
+            const T* choice = choices.Find(str);
+            if (choice == nullptr) {
+                return false;
+            }
+            value = *choice;
+            return true;
+        }
+
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            value = str;
+            if (!str.empty()) {
+                return true;
+            }
+        }
+
+        if constexpr (std::is_same_v<T, std::string>) {
+            value.assign(str);
+            if (!str.empty() && str.find_first_of(" \t\n\v\f\r") == std::string_view::npos) {
+                return true;
+            }
+        }
+
+        if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+            if (std::from_chars(str.data(), str.data() + str.size(), value).ec == std::errc()) {
+                return true;
+            }
+        }
+
+        if constexpr (requires(std::istream& stream) { stream >> value; }) {
+            std::istringstream stream{std::string(str)};
+            stream >> value;
+
+            if (!stream.fail()) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    template<typename T>
+    static std::string ConvertToString(const T& value, const ChoiceView<T>& choices) {
+        std::string_view name = choices.NameOf(value);
+        if (!name.empty()) {
+            return std::string(name);
+        }
+
+        std::ostringstream ss;
+        ss << std::boolalpha;
+
+        if constexpr (requires { ss << value; }) {
+            ss << value;
+        }
+
+        return ss.str();
+    }
+
     void PrintError(const ArgumentError& error) const;
 
-    const std::string long_name_;
+    void ResolvePending() const;
+
+    const std::string_view long_name_;
+    const std::string_view description_;
     const std::optional<char> short_name_;
-    std::string description_;
     bool is_positional_ = false;
+    bool is_eager_ = false;
+    char delimiter_ = '\0';
+    // Position in the parser's argument list, used as the bit of the argument in constraint masks
+    size_t index_ = 0;
+
+    // Raw values stored by a lazy Parse, converted on first access
+    std::vector<std::string_view> pending_values_;
 };
 
 template<typename T, bool Multivalued = false>
 class Argument : public ArgumentBase {
   public:
-    explicit Argument(std::string long_name, const std::string& description = "")
-            : ArgumentBase(std::move(long_name), std::move(description)) {}
+    explicit Argument(std::string_view long_name, std::string_view description = "")
+            : ArgumentBase(long_name, description) {}
 
-    explicit Argument(char short_name, std::string long_name, std::string description = "")
-            : ArgumentBase(short_name, std::move(long_name), std::move(description)) {}
+    explicit Argument(char short_name, std::string_view long_name, std::string_view description = "")
+            : ArgumentBase(short_name, long_name, description) {}
 
-    void SetValueFromString(const std::string& value) override {
+    [[nodiscard]] T ConvertValue(std::string_view value) const {
         T val;
+        ConvertFromString(value, choices_, val);
 
-        std::istringstream stream(value);
-        stream >> val;
+        return val;
+    }
+
+    void SetDefaultFromString(std::string_view value) override {
+        T val;
+        ConvertFromString(value, choices_, val);
 
-        value_ = std::move(val);
+        Default(val);
+    }
 
-        if (stream.fail()) {
-            PrintError(InvalidArgumentType);
+    void SetValueFromString(std::string_view value) override {
+        T val;
+        ConvertFromString(value, choices_, val);
+
+        if (target_ != nullptr) {
+            *target_ = Own(std::move(val));
+            target_is_default_ = false;
+        } else {
+            value_ = Own(std::move(val));
         }
     }
 
     Argument& SetValue(const T& value) {
-        value_ = value;
+        pending_values_.clear();
+
+        if (target_ != nullptr) {
+            *target_ = Own(value);
+            target_is_default_ = false;
+        } else {
+            value_ = Own(value);
+        }
 
         return *this;
     }
 
     [[nodiscard]] bool HasValue() const override {
-        return value_.has_value() || default_value_.has_value();
+        return target_ != nullptr || value_.has_value() || default_value_.has_value() || !pending_values_.empty();
     }
 
     T GetValue() const {
+        return GetValueRef();
+    }
+
+    // The reference stays valid until the argument is parsed again or its value is taken
+    const T& GetValueRef() const {
+        ResolvePending();
+
         if (!HasValue()) {
             PrintError(NoArgumentValue);
         }
 
+        if (target_ != nullptr) {
+            return *target_;
+        }
+
         return value_.has_value() ? value_.value() : default_value_.value();
     }
 
+    // Moves the parsed value out, afterwards the argument falls back to its default
+    T TakeValue() {
+        ResolvePending();
+
+        if (!HasValue()) {
+            PrintError(NoArgumentValue);
+        }
+
+        if (target_ != nullptr) {
+            return std::move(*target_);
+        }
+
+        if (!value_.has_value()) {
+            return default_value_.value();
+        }
+
+        T value = std::move(value_.value());
+        value_.reset();
+
+        return value;
+    }
+
     Argument& Default(const T& value) {
-        default_value_ = value;
+        default_value_ = Own(value);
+
+        return *this;
+    }
+
+    // Restricts accepted values to the names of a static table, the table must outlive the argument
+    template<size_t N>
+    Argument& Choices(const ChoiceTable<T, N>& table) {
+        choices_ = ChoiceView<T>(table);
 
         return *this;
     }
 
+    template<size_t N>
+    Argument& Choices(const ChoiceTable<T, N>&& table) = delete;
+
     Argument& Positional() {
         is_positional_ = true;
 
         return *this;
     }
 
+    // Converts values during Parse even if the parser is lazy
+    Argument& Eager() {
+        is_eager_ = true;
+
+        return *this;
+    }
+
+    // Parsed values are written straight into target, its current value is used as the default
+    Argument& Bind(T& target) {
+        target_ = &target;
+        target_is_default_ = true;
+        is_eager_ = true;
+
+        return *this;
+    }
+
     T& GetStorage() {
+        is_eager_ = true;
+        ResolvePending();
+
+        if (target_ != nullptr) {
+            return *target_;
+        }
+
         if (!value_.has_value()) {
             value_ = default_value_.has_value() ? default_value_.value() : T();
         }
@@ -155,6 +368,12 @@ class Argument : public ArgumentBase {
     }
 
     const T& GetStorage() const {
+        ResolvePending();
+
+        if (target_ != nullptr) {
+            return *target_;
+        }
+
         if (!value_.has_value()) {
             value_ = default_value_.has_value() ? default_value_.value() : T();
         }
@@ -172,7 +391,7 @@ class Argument : public ArgumentBase {
 
   private:
     [[nodiscard]] bool HasDefaultValue() const override {
-        return default_value_.has_value();
+        return target_ != nullptr || default_value_.has_value();
     }
 
     [[nodiscard]] size_t MinSize() const override {
@@ -180,14 +399,84 @@ class Argument : public ArgumentBase {
     }
 
     [[nodiscard]] std::string DefaultValueString() const override {
-        std::ostringstream ss;
-        ss << std::boolalpha;
+        return ConvertToString(target_ != nullptr ? *target_ : default_value_.value(), choices_);
+    }
 
-        ss << default_value_.value();
+    [[nodiscard]] bool HasChoices() const override {
+        return static_cast<bool>(choices_);
+    }
 
-        return ss.str();
+    [[nodiscard]] std::string ChoicesString() const override {
+        return choices_.Names();
+    }
+
+    [[nodiscard]] const void* ChoicesTable() const override {
+        return choices_.Table();
+    }
+
+    void SaveValue(SnapshotWriter& writer) const override {
+        ResolvePending();
+
+        // An unparsed bound target still holds the caller's default, which belongs to that caller only
+        const bool has_value = target_ != nullptr ? !target_is_default_ : value_.has_value();
+        const uint32_t count = has_value ? 1 : 0;
+        writer.Write(&count, sizeof(count));
+
+        if (count != 0) {
+            writer.WriteValue(target_ != nullptr ? *target_ : value_.value());
+        }
+    }
+
+    bool LoadValue(SnapshotReader& reader) override {
+        uint32_t count = 0;
+        if (!reader.Read(&count, sizeof(count)) || count > 1) {
+            return false;
+        }
+
+        if (count == 0) {
+            pending_values_.clear();
+            value_.reset();
+            return true;
+        }
+
+        T val;
+        if (!reader.ReadValue(val)) {
+            return false;
+        }
+        SetValue(val);
+
+        return true;
+    }
+
+    [[nodiscard]] bool IsValidValue(std::string_view value) const override {
+        T val;
+        return TryConvertFromString(value, choices_, val);
+    }
+
+    bool SkipValue(SnapshotReader& reader) const override {
+        uint32_t count = 0;
+        if (!reader.Read(&count, sizeof(count)) || count > 1) {
+            return false;
+        }
+
+        T val;
+        return count == 0 || reader.ReadValue(val);
     }
 
+    // std::string_view values are copied into the argument's intern pool, so they outlive the command line
+    // and repeated values share one copy
+    T Own(T value) {
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            return interned_.Intern(value);
+        } else {
+            return value;
+        }
+    }
+
+    T* target_ = nullptr;
+    ChoiceView<T> choices_;
+    bool target_is_default_ = false;
+    [[no_unique_address]] std::conditional_t<std::is_same_v<T, std::string_view>, InternPool, std::monostate> interned_;
     std::optional<T> value_;
     std::optional<T> default_value_;
 };
@@ -195,61 +484,182 @@ class Argument : public ArgumentBase {
 template<typename T>
 class Argument<T, true> : public ArgumentBase {
   public:
-    explicit Argument(std::string long_name, size_t min_size, const std::string& description = "")
-            : ArgumentBase(std::move(long_name), std::move(description)), min_size_(min_size) {}
+    explicit Argument(std::string_view long_name, size_t min_size, std::string_view description = "")
+            : ArgumentBase(long_name, description), min_size_(min_size) {}
+
+    explicit Argument(char short_name, std::string_view long_name, size_t min_size, std::string_view description = "")
+            : ArgumentBase(short_name, long_name, description), min_size_(min_size) {}
 
-    explicit Argument(char short_name, std::string long_name, size_t min_size, std::string description = "")
-            : ArgumentBase(short_name, std::move(long_name), std::move(description)), min_size_(min_size) {}
+    [[nodiscard]] T ConvertValue(std::string_view value) const {
+        T val;
+        ConvertFromString(value, choices_, val);
+
+        return val;
+    }
 
-    void SetValueFromString(const std::string& value) override {
+    void SetDefaultFromString(std::string_view value) override {
         T val;
+        ConvertFromString(value, choices_, val);
 
-        std::istringstream stream(value);
-        stream >> val;
+        Default(val);
+    }
+
+    void SetValueFromString(std::string_view value) override {
+        std::vector<T>& values = Values();
+
+        if (delimiter_ == '\0') {
+            T val;
+            ConvertFromString(value, choices_, val);
+            values.push_back(Own(std::move(val)));
+            return;
+        }
 
-        value_.push_back(std::move(val));
+        // The list is counted first, so that a long inline list costs one reallocation at most
+        const size_t size = values.size() + std::count(value.begin(), value.end(), delimiter_) + 1;
+        if (values.capacity() < size) {
+            values.reserve(std::max(size, 2 * values.capacity()));
+        }
+
+        for (size_t begin = 0;;) {
+            const size_t end = value.find(delimiter_, begin);
 
-        if (stream.fail()) {
-            PrintError(InvalidArgumentType);
+            T val;
+            ConvertFromString(value.substr(begin, end - begin), choices_, val);
+            values.push_back(Own(std::move(val)));
+
+            if (end == std::string_view::npos) {
+                break;
+            }
+            begin = end + 1;
         }
     }
 
     Argument& SetValue(const T& value) {
-        value_.push_back(value);
+        ResolvePending();
+        Values().push_back(Own(value));
 
         return *this;
     }
 
     [[nodiscard]] bool HasValue() const override {
-        return value_.size() >= min_size_ || default_value_.has_value();
+        size_t pending = pending_values_.size();
+        if (delimiter_ != '\0') {
+            for (std::string_view value : pending_values_) {
+                pending += std::count(value.begin(), value.end(), delimiter_);
+            }
+        }
+
+        return Values().size() + pending >= min_size_ || default_value_.has_value();
     }
 
     T GetValue(size_t index = 0) const {
-        if (!HasValue() || index >= value_.size()) {
+        ResolvePending();
+
+        const std::vector<T>& values = Values();
+
+        if (!HasValue() || index >= values.size()) {
+            PrintError(NoArgumentValue);
+        }
+
+        return index < values.size() ? values.at(index) : default_value_.value();
+    }
+
+    // All values without copying, a default is returned as a single element
+    std::span<const T> GetValues() const {
+        ResolvePending();
+
+        if (!HasValue()) {
+            PrintError(NoArgumentValue);
+        }
+
+        const std::vector<T>& values = Values();
+
+        if (values.empty() && default_value_.has_value()) {
+            return {&default_value_.value(), 1};
+        }
+
+        return values;
+    }
+
+    // Moves the parsed values out, leaving the argument empty
+    std::vector<T> TakeValues() {
+        ResolvePending();
+
+        if (!HasValue()) {
             PrintError(NoArgumentValue);
         }
 
-        return index < value_.size() ? value_.at(index) : default_value_.value();
+        // Values() would drop the initial elements of a bound vector, here they are the value being taken
+        std::vector<T>& values = target_ != nullptr ? *target_ : value_;
+        target_is_default_ = false;
+
+        if (values.empty() && default_value_.has_value()) {
+            return {default_value_.value()};
+        }
+
+        std::vector<T> result = std::move(values);
+        values.clear();
+
+        return result;
     }
 
     Argument& Default(const T& val) {
-        default_value_ = val;
+        default_value_ = Own(val);
+
+        return *this;
+    }
+
+    // Restricts accepted values to the names of a static table, the table must outlive the argument
+    template<size_t N>
+    Argument& Choices(const ChoiceTable<T, N>& table) {
+        choices_ = ChoiceView<T>(table);
 
         return *this;
     }
 
+    template<size_t N>
+    Argument& Choices(const ChoiceTable<T, N>&& table) = delete;
+
     Argument& Positional() {
         is_positional_ = true;
 
         return *this;
     }
 
+    // Accepts several values in one token, like --ids=1,2,3
+    Argument& Delimiter(char delimiter = ',') {
+        delimiter_ = delimiter;
+
+        return *this;
+    }
+
+    // Converts values during Parse even if the parser is lazy
+    Argument& Eager() {
+        is_eager_ = true;
+
+        return *this;
+    }
+
+    // Parsed values are appended straight into target, its initial elements are replaced by the first parsed value
+    Argument& Bind(std::vector<T>& target) {
+        target_ = &target;
+        target_is_default_ = !target.empty();
+        is_eager_ = true;
+
+        return *this;
+    }
+
     std::vector<T>& GetStorage() {
-        return value_;
+        is_eager_ = true;
+        ResolvePending();
+
+        return target_ != nullptr ? *target_ : value_;
     }
 
     const std::vector<T>& GetStorage() const {
-        return value_;
+        ResolvePending();
+
+        return target_ != nullptr ? *target_ : value_;
     }
 
     [[nodiscard]] const std::type_info& GetType() const override {
@@ -262,23 +672,133 @@ class Argument<T, true> : public ArgumentBase {
 
   private:
     [[nodiscard]] bool HasDefaultValue() const override {
-        return default_value_.has_value();
+        return target_is_default_ || default_value_.has_value();
     }
 
     [[nodiscard]] size_t MinSize() const override {
         return min_size_;
     }
 
+    // The initial elements of a bound vector are shown separated by spaces
     [[nodiscard]] std::string DefaultValueString() const override {
-        std::ostringstream ss;
-        ss << std::boolalpha;
+        if (!target_is_default_) {
+            return ConvertToString(default_value_.value(), choices_);
+        }
 
-        ss << default_value_.value();
+        std::string result;
+        for (const T& val : *target_) {
+            if (!result.empty()) {
+                result += ' ';
+            }
+            result += ConvertToString(val, choices_);
+        }
 
-        return ss.str();
+        return result;
+    }
+
+    [[nodiscard]] bool HasChoices() const override {
+        return static_cast<bool>(choices_);
+    }
+
+    [[nodiscard]] std::string ChoicesString() const override {
+        return choices_.Names();
+    }
+
+    [[nodiscard]] const void* ChoicesTable() const override {
+        return choices_.Table();
+    }
+
+    void SaveValue(SnapshotWriter& writer) const override {
+        ResolvePending();
+
+        // Bound defaults were not parsed, so they are saved as no values and kept by LoadValue
+        const std::vector<T>& values = Values();
+
+        const auto count = target_is_default_ ? 0 : static_cast<uint32_t>(values.size());
+        writer.Write(&count, sizeof(count));
+
+        for (uint32_t i = 0; i < count; ++i) {
+            writer.WriteValue(values[i]);
+        }
+    }
+
+    bool LoadValue(SnapshotReader& reader) override {
+        uint32_t count = 0;
+        if (!reader.Read(&count, sizeof(count))) {
+            return false;
+        }
+
+        std::vector<T> values;
+        for (uint32_t i = 0; i < count; ++i) {
+            T val;
+            if (!reader.ReadValue(val)) {
+                return false;
+            }
+            values.push_back(Own(std::move(val)));
+        }
+
+        pending_values_.clear();
+        if (count == 0 && target_is_default_) {
+            return true;
+        }
+        Values() = std::move(values);
+
+        return true;
+    }
+
+    [[nodiscard]] bool IsValidValue(std::string_view value) const override {
+        T val;
+        return TryConvertFromString(value, choices_, val);
+    }
+
+    bool SkipValue(SnapshotReader& reader) const override {
+        uint32_t count = 0;
+        if (!reader.Read(&count, sizeof(count))) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            T val;
+            if (!reader.ReadValue(val)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // std::string_view values are copied into the argument's intern pool, so they outlive the command line
+    // and repeated values share one copy
+    T Own(T value) {
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            return interned_.Intern(value);
+        } else {
+            return value;
+        }
+    }
+
+    std::vector<T>& Values() {
+        if (target_ == nullptr) {
+            return value_;
+        }
+
+        if (target_is_default_) {
+            target_->clear();
+            target_is_default_ = false;
+        }
+
+        return *target_;
+    }
+
+    [[nodiscard]] const std::vector<T>& Values() const {
+        return target_ != nullptr ? *target_ : value_;
     }
 
     const size_t min_size_;
+    std::vector<T>* target_ = nullptr;
+    ChoiceView<T> choices_;
+    bool target_is_default_ = false;
+    [[no_unique_address]] std::conditional_t<std::is_same_v<T, std::string_view>, InternPool, std::monostate> interned_;
     std::vector<T> value_;
     std::optional<T> default_value_;
 };
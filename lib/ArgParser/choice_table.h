@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ArgumentParser {
+
+// Compile-time table of allowed string values, looked up through a perfect hash built with hash-and-displace:
+// the name is hashed once, the hash picks a bucket and the bucket's displacement remixes it into a unique slot
+template<typename T, size_t N>
+class ChoiceTable {
+  public:
+    using Entry = std::pair<std::string_view, T>;
+
+    static_assert(N > 0, "choice table cannot be empty");
+
+    constexpr explicit ChoiceTable(const Entry (&entries)[N]) {
+        std::copy(entries, entries + N, entries_.begin());
+        Build();
+    }
+
+    [[nodiscard]] constexpr const T* Find(std::string_view name) const {
+        const uint64_t hash = Hash(name);
+        const uint32_t index = slots_[Slot(hash, displacements_[hash & (kBuckets - 1)])];
+
+        if (index == kEmpty || entries_[index].first != name) {
+            return nullptr;
+        }
+
+        return &entries_[index].second;
+    }
+
+    [[nodiscard]] constexpr const std::array<Entry, N>& Entries() const {
+        return entries_;
+    }
+
+  private:
+    static constexpr size_t kBuckets = std::bit_ceil(N);
+    static constexpr size_t kSlots = std::bit_ceil(2 * N);
+    static constexpr uint32_t kEmpty = N;
+
+    static constexpr uint64_t Hash(std::string_view name) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    static constexpr uint32_t Slot(uint64_t hash, uint32_t displacement) {
+        hash ^= displacement * 0x9e3779b97f4a7c15ull;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+
+        return static_cast<uint32_t>(hash & (kSlots - 1));
+    }
+
+    constexpr void Build() {
+        std::array<uint64_t, N> hashes{};
+        std::array<uint32_t, N> bucket_of{};
+        std::array<uint32_t, kBuckets> bucket_size{};
+        std::array<uint32_t, N> order{};
+
+        for (uint32_t i = 0; i < N; ++i) {
+            hashes[i] = Hash(entries_[i].first);
+            bucket_of[i] = hashes[i] & (kBuckets - 1);
+            ++bucket_size[bucket_of[i]];
+            order[i] = i;
+        }
+
+        // Largest buckets are placed first while the slot array is still sparse
+        std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+            if (bucket_size[bucket_of[lhs]] != bucket_size[bucket_of[rhs]]) {
+                return bucket_size[bucket_of[lhs]] > bucket_size[bucket_of[rhs]];
+            }
+            return bucket_of[lhs] < bucket_of[rhs];
+        });
+
+        slots_.fill(kEmpty);
+        displacements_.fill(0);
+
+        for (size_t begin = 0; begin < N;) {
+            const uint32_t bucket = bucket_of[order[begin]];
+            const size_t end = begin + bucket_size[bucket];
+
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t j = begin; j < i; ++j) {
+                    if (hashes[order[i]] == hashes[order[j]]) {
+                        throw std::logic_error("duplicate choice name");
+                    }
+                }
+            }
+
+            for (uint32_t displacement = 1;; ++displacement) {
+                bool fits = true;
+
+                for (size_t i = begin; i < end && fits; ++i) {
+                    const uint32_t slot = Slot(hashes[order[i]], displacement);
+                    fits = slots_[slot] == kEmpty;
+
+                    for (size_t j = begin; j < i && fits; ++j) {
+                        fits = slot != Slot(hashes[order[j]], displacement);
+                    }
+                }
+
+                if (fits) {
+                    for (size_t i = begin; i < end; ++i) {
+                        slots_[Slot(hashes[order[i]], displacement)] = order[i];
+                    }
+                    displacements_[bucket] = displacement;
+                    break;
+                }
+            }
+
+            begin = end;
+        }
+    }
+
+    std::array<Entry, N> entries_{};
+    std::array<uint32_t, kBuckets> displacements_{};
+    std::array<uint32_t, kSlots> slots_{};
+};
+
+// Type-erased reference to a ChoiceTable<T, N>, the table must outlive the view
+template<typename T>
+class ChoiceView {
+  public:
+    using Entry = std::pair<std::string_view, T>;
+
+    ChoiceView() = default;
+
+    template<size_t N>
+    explicit ChoiceView(const ChoiceTable<T, N>& table) : table_(&table), ops_(&kOps<N>) {}
+
+    explicit operator bool() const {
+        return table_ != nullptr;
+    }
+
+    // Identity of the viewed table, nullptr for an empty view
+    [[nodiscard]] const void* Table() const {
+        return table_;
+    }
+
+    [[nodiscard]] const T* Find(std::string_view name) const {
+        return ops_->find(table_, name);
+    }
+
+    [[nodiscard]] std::string_view NameOf(const T& value) const {
+        if constexpr (requires { value == value; }) {
+            if (table_ != nullptr) {
+                for (const auto& [name, entry_value] : ops_->entries(table_)) {
+                    if (entry_value == value) {
+                        return name;
+                    }
+                }
+            }
+        }
+
+        return {};
+    }
+
+    [[nodiscard]] std::string Names() const {
+        std::string names;
+        if (table_ == nullptr) {
+            return names;
+        }
+
+        for (const auto& [name, value] : ops_->entries(table_)) {
+            if (!names.empty()) {
+                names += '|';
+            }
+            names += name;
+        }
+
+        return names;
+    }
+
+  private:
+    // Shared per table size, so that a view costs two pointers
+    struct Ops {
+        const T* (* find)(const void*, std::string_view);
+        std::span<const Entry> (* entries)(const void*);
+    };
+
+    template<size_t N>
+    static constexpr Ops kOps = {
+        [](const void* table, std::string_view name) {
+            return static_cast<const ChoiceTable<T, N>*>(table)->Find(name);
+        },
+        [](const void* table) {
+            return std::span<const Entry>(static_cast<const ChoiceTable<T, N>*>(table)->Entries());
+        },
+    };
+
+    const void* table_ = nullptr;
+    const Ops* ops_ = nullptr;
+};
+
+} // ArgumentParser
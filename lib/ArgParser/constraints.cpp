@@ -0,0 +1,149 @@
+#include "constraints.h"
+#include "argument.h"
+
+#include <bit>
+
+using namespace ArgumentParser;
+
+namespace {
+
+uint64_t Word(const ArgumentMask& mask, size_t index) {
+    return index < mask.size() ? mask[index] : 0;
+}
+
+bool Test(const ArgumentMask& mask, size_t index) {
+    return (Word(mask, index / 64) >> (index % 64)) & 1;
+}
+
+std::string Name(size_t index, std::span<const std::unique_ptr<ArgumentBase>> arguments) {
+    return "--" + arguments[index]->GetLongName();
+}
+
+// Names of the arguments in mask, as "--a, --b"
+std::string Names(const ArgumentMask& mask, std::span<const std::unique_ptr<ArgumentBase>> arguments) {
+    std::string names;
+
+    for (size_t word = 0; word < mask.size(); ++word) {
+        for (uint64_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+            if (!names.empty()) {
+                names += ", ";
+            }
+            names += Name(word * 64 + std::countr_zero(bits), arguments);
+        }
+    }
+
+    return names;
+}
+
+} // namespace
+
+void Constraints::Set(ArgumentMask& mask, size_t index) {
+    if (index / 64 >= mask.size()) {
+        mask.resize(index / 64 + 1);
+    }
+
+    mask[index / 64] |= uint64_t{1} << (index % 64);
+}
+
+void Constraints::Add(ConstraintKind kind, size_t argument, std::span<const size_t> others) {
+    if (kind == ConstraintKind::Required) {
+        Set(required_, argument);
+        return;
+    }
+
+    Constraint constraint{kind, argument, {}, 0};
+    for (size_t index : others) {
+        Set(constraint.mask, index);
+    }
+    for (uint64_t word : constraint.mask) {
+        constraint.size += std::popcount(word);
+    }
+
+    constraints_.push_back(std::move(constraint));
+}
+
+bool Constraints::Empty() const {
+    return required_.empty() && constraints_.empty();
+}
+
+uint64_t Constraints::Hash(uint64_t hash) const {
+    const auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+
+    for (uint64_t word : required_) {
+        mix(word);
+    }
+
+    for (const Constraint& constraint : constraints_) {
+        mix(static_cast<uint64_t>(constraint.kind));
+        mix(constraint.argument);
+        for (uint64_t word : constraint.mask) {
+            mix(word);
+        }
+    }
+
+    return hash;
+}
+
+std::vector<std::string> Constraints::Check(const ArgumentMask& present,
+                                            std::span<const std::unique_ptr<ArgumentBase>> arguments) const {
+    std::vector<std::string> violations;
+
+    // Masks of the offending arguments are only built once a rule is known to be violated
+    const auto select = [&present](const ArgumentMask& mask, bool is_present) {
+        ArgumentMask selected(mask.size());
+        for (size_t word = 0; word < mask.size(); ++word) {
+            selected[word] = mask[word] & (is_present ? Word(present, word) : ~Word(present, word));
+        }
+        return selected;
+    };
+
+    bool any_missing = false;
+    for (size_t word = 0; word < required_.size(); ++word) {
+        any_missing |= (required_[word] & ~Word(present, word)) != 0;
+    }
+
+    if (any_missing) {
+        violations.push_back("missing required arguments: " + Names(select(required_, false), arguments));
+    }
+
+    for (const Constraint& constraint : constraints_) {
+        size_t count = 0;
+        for (size_t word = 0; word < constraint.mask.size(); ++word) {
+            count += std::popcount(constraint.mask[word] & Word(present, word));
+        }
+
+        switch (constraint.kind) {
+            case ConstraintKind::MutuallyExclusive:
+                if (count > 1) {
+                    violations.push_back("arguments " + Names(select(constraint.mask, true), arguments)
+                                         + " are mutually exclusive");
+                }
+                break;
+            case ConstraintKind::AtLeastOneOf:
+                if (count == 0) {
+                    violations.push_back("one of the arguments " + Names(constraint.mask, arguments)
+                                         + " is required");
+                }
+                break;
+            case ConstraintKind::Requires:
+                if (Test(present, constraint.argument) && count != constraint.size) {
+                    violations.push_back("argument " + Name(constraint.argument, arguments) + " requires "
+                                         + Names(select(constraint.mask, false), arguments));
+                }
+                break;
+            case ConstraintKind::ConflictsWith:
+                if (Test(present, constraint.argument) && count != 0) {
+                    violations.push_back("argument " + Name(constraint.argument, arguments) + " conflicts with "
+                                         + Names(select(constraint.mask, true), arguments));
+                }
+                break;
+            case ConstraintKind::Required:
+                break;
+        }
+    }
+
+    return violations;
+}
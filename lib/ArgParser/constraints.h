@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ArgumentParser {
+
+class ArgumentBase;
+
+// One bit per argument index
+using ArgumentMask = std::vector<uint64_t>;
+
+enum class ConstraintKind {
+    Required,
+    MutuallyExclusive,
+    AtLeastOneOf,
+    Requires,
+    ConflictsWith,
+};
+
+// Rules over which arguments appear on the command line together. Every rule is compiled into a mask over argument
+// indices, so checking it costs one pass over the mask words
+class Constraints {
+  public:
+    // argument is the index a Requires or ConflictsWith rule is attached to, others are the indices the rule refers to
+    void Add(ConstraintKind kind, size_t argument, std::span<const size_t> others);
+
+    [[nodiscard]] bool Empty() const;
+
+    // Mixes every rule into hash, parsers with equal rules give equal results
+    [[nodiscard]] uint64_t Hash(uint64_t hash) const;
+
+    // Describes every rule violated by the arguments present
+    [[nodiscard]] std::vector<std::string> Check(const ArgumentMask& present,
+                                                 std::span<const std::unique_ptr<ArgumentBase>> arguments) const;
+
+    static void Set(ArgumentMask& mask, size_t index);
+
+  private:
+    struct Constraint {
+        ConstraintKind kind;
+        size_t argument;
+        ArgumentMask mask;
+        // Number of arguments in mask
+        size_t size;
+    };
+
+    // All required arguments are checked through a single mask
+    ArgumentMask required_;
+    std::vector<Constraint> constraints_;
+};
+
+} // ArgumentParser
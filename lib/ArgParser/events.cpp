@@ -0,0 +1,170 @@
+#include "events.h"
+#include "token.h"
+
+using namespace ArgumentParser;
+
+EventKind ParseEvent::GetKind() const {
+    return kind_;
+}
+
+const ArgumentBase* ParseEvent::GetArgument() const {
+    return argument_;
+}
+
+std::string_view ParseEvent::GetLongName() const {
+    return argument_ != nullptr ? argument_->long_name_ : std::string_view();
+}
+
+std::string_view ParseEvent::GetToken() const {
+    return token_;
+}
+
+ArgParserError ParseEvent::GetError() const {
+    return error_;
+}
+
+bool ParseEvent::HasValidValue() const {
+    return kind_ != EventKind::Error && argument_ != nullptr && argument_->IsValidValue(token_);
+}
+
+ParseEvents::ParseEvents(ArgParser& parser, const std::vector<std::string>& vec)
+        : parser_(parser), strings_(vec.data()), size_(vec.size()) {}
+
+ParseEvents::ParseEvents(ArgParser& parser, int argc, char** argv)
+        : parser_(parser), argv_(argv), size_(argc) {}
+
+ParseEvents::Iterator ParseEvents::begin() {
+    return Iterator(this);
+}
+
+std::default_sentinel_t ParseEvents::end() const {
+    return std::default_sentinel;
+}
+
+std::string_view ParseEvents::Token(size_t index) const {
+    return strings_ != nullptr ? std::string_view(strings_[index]) : std::string_view(argv_[index]);
+}
+
+bool ParseEvents::Next(ParseEvent& event) {
+    if (list_argument_ != nullptr) {
+        return NextListItem(event);
+    }
+
+    if (!cluster_.empty()) {
+        return NextShort(event);
+    }
+
+    while (index_ < size_) {
+        const std::string_view token = Token(index_++);
+        size_t border = std::string_view::npos;
+        const TokenKind kind = options_ended_ ? TokenKind::Positional : ClassifyToken(token, border);
+
+        switch (kind) {
+            case TokenKind::Separator:
+                options_ended_ = true;
+                break;
+
+            case TokenKind::Long:
+            case TokenKind::LongWithValue: {
+                auto iter = parser_.argument_map_.find(token.substr(2, border - 2));
+
+                if (iter == parser_.argument_map_.end()) {
+                    return Fail(event, UnknownArgument, nullptr, token);
+                }
+
+                const ArgumentBase* argument = iter->second;
+                const bool flag = argument->GetType() == typeid(bool);
+
+                if (kind == TokenKind::Long) {
+                    return flag ? Emit(event, EventKind::Option, argument, "1")
+                                : Fail(event, MissingArgumentValue, argument, token);
+                }
+
+                const std::string_view value = token.substr(border + 1);
+
+                if (!flag && value.empty()) {
+                    return Fail(event, MissingArgumentValue, argument, token);
+                }
+
+                return Emit(event, EventKind::Option, argument, value);
+            }
+
+            case TokenKind::ShortCluster:
+                cluster_ = token.substr(1);
+                return NextShort(event);
+
+            case TokenKind::Positional:
+                return Emit(event, EventKind::Positional, parser_.FindPositional(), token);
+        }
+    }
+
+    return false;
+}
+
+bool ParseEvents::NextShort(ParseEvent& event) {
+    const std::string_view short_name = cluster_.substr(0, 1);
+    cluster_.remove_prefix(1);
+
+    const ArgumentBase* argument = parser_.short_arguments_[static_cast<unsigned char>(short_name[0])];
+
+    if (argument == nullptr) {
+        return Fail(event, UnknownArgument, nullptr, short_name);
+    }
+
+    if (argument->GetType() == typeid(bool)) {
+        return Emit(event, EventKind::Option, argument, "1");
+    }
+
+    // A value-taking option has to end its cluster, the value is the next token
+    if (!cluster_.empty()) {
+        cluster_ = {};
+        return Fail(event, UnknownArgument, argument, short_name);
+    }
+
+    if (index_ == size_) {
+        return Fail(event, MissingArgumentValue, argument, short_name);
+    }
+
+    return Emit(event, EventKind::Option, argument, Token(index_++));
+}
+
+bool ParseEvents::NextListItem(ParseEvent& event) {
+    const size_t end = list_.find(list_argument_->delimiter_);
+
+    event.kind_ = list_kind_;
+    event.argument_ = list_argument_;
+    event.token_ = list_.substr(0, end);
+
+    if (end == std::string_view::npos) {
+        list_argument_ = nullptr;
+    } else {
+        list_.remove_prefix(end + 1);
+    }
+
+    return true;
+}
+
+bool ParseEvents::Emit(ParseEvent& event, EventKind kind, const ArgumentBase* argument, std::string_view value) {
+    if (argument != nullptr && argument->delimiter_ != '\0') {
+        list_kind_ = kind;
+        list_argument_ = argument;
+        list_ = value;
+
+        return NextListItem(event);
+    }
+
+    event.kind_ = kind;
+    event.argument_ = argument;
+    event.token_ = value;
+
+    return true;
+}
+
+bool ParseEvents::Fail(ParseEvent& event, ArgParserError error, const ArgumentBase* argument, std::string_view token) {
+    event.kind_ = EventKind::Error;
+    event.argument_ = argument;
+    event.token_ = token;
+    event.error_ = error;
+
+    return true;
+}
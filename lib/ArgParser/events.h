@@ -0,0 +1,139 @@
+#pragma once
+
+#include "arg_parser.h"
+
+#include <iterator>
+
+namespace ArgumentParser {
+
+enum class EventKind {
+    Option,
+    Positional,
+    Error,
+};
+
+// One step of a ParseEvents stream. The value is kept as a view of the command line and only converted on request
+class ParseEvent {
+  public:
+    [[nodiscard]] EventKind GetKind() const;
+
+    // Matched argument, nullptr for unknown arguments and for positional values when no argument is positional
+    [[nodiscard]] const ArgumentBase* GetArgument() const;
+
+    [[nodiscard]] std::string_view GetLongName() const;
+
+    // Raw value for options and positionals, the offending token for errors
+    [[nodiscard]] std::string_view GetToken() const;
+
+    [[nodiscard]] ArgParserError GetError() const;
+
+    // Whether GetValue would succeed, false for errors and for positional values without an argument
+    [[nodiscard]] bool HasValidValue() const;
+
+    template<typename T>
+    T GetValue() const {
+        if (argument_ == nullptr) {
+            ArgParser::PrintError(NoPositionalArgument, std::string(token_));
+        }
+
+        if (argument_->GetType() != typeid(T)) {
+            argument_->PrintError(InvalidArgumentType);
+        }
+
+        if (argument_->IsMultivalued()) {
+            return static_cast<const Argument<T, true>*>(argument_)->ConvertValue(token_);
+        }
+
+        return static_cast<const Argument<T>*>(argument_)->ConvertValue(token_);
+    }
+
+  private:
+    friend class ParseEvents;
+
+    EventKind kind_ = EventKind::Error;
+    const ArgumentBase* argument_ = nullptr;
+    std::string_view token_;
+    ArgParserError error_ = UnknownArgument;
+};
+
+// Walks a command line against the parser's schema and yields events in command line order.
+// Nothing is stored in the parser, so arbitrarily long inputs are processed in constant memory
+class ParseEvents {
+  public:
+    class Iterator {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ParseEvent;
+        using difference_type = std::ptrdiff_t;
+
+        explicit Iterator(ParseEvents* events) : events_(events) {
+            ++*this;
+        }
+
+        const ParseEvent& operator*() const {
+            return event_;
+        }
+
+        const ParseEvent* operator->() const {
+            return &event_;
+        }
+
+        Iterator& operator++() {
+            done_ = !events_->Next(event_);
+
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const {
+            return done_;
+        }
+
+      private:
+        ParseEvents* events_;
+        ParseEvent event_;
+        bool done_ = false;
+    };
+
+    // The tokens are not copied and must outlive the stream, the first one is the program name
+    ParseEvents(ArgParser& parser, const std::vector<std::string>& vec);
+
+    ParseEvents(ArgParser& parser, int argc, char** argv);
+
+    bool Next(ParseEvent& event);
+
+    Iterator begin();
+
+    [[nodiscard]] std::default_sentinel_t end() const;
+
+  private:
+    [[nodiscard]] std::string_view Token(size_t index) const;
+
+    bool NextShort(ParseEvent& event);
+
+    bool NextListItem(ParseEvent& event);
+
+    bool Emit(ParseEvent& event, EventKind kind, const ArgumentBase* argument, std::string_view value);
+
+    static bool Fail(ParseEvent& event, ArgParserError error, const ArgumentBase* argument, std::string_view token);
+
+    ArgParser& parser_;
+    const std::string* strings_ = nullptr;
+    char** argv_ = nullptr;
+    size_t size_ = 0;
+    size_t index_ = 1;
+    bool options_ended_ = false;
+
+    // Rest of the current short cluster
+    std::string_view cluster_;
+
+    // Rest of the current delimited list
+    EventKind list_kind_ = EventKind::Option;
+    const ArgumentBase* list_argument_ = nullptr;
+    std::string_view list_;
+};
+
+} // ArgumentParser
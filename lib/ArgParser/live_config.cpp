@@ -0,0 +1,220 @@
+#include "live_config.h"
+#include "events.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/membarrier.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace ArgumentParser;
+
+LiveConfig::LiveConfig(std::string name, std::function<void(ArgParser&)> schema, std::string path)
+        : name_(std::move(name)), schema_(std::move(schema)), path_(std::move(path)) {
+    if (!Reload()) {
+        std::cerr << "error: cannot load configuration " << path_ << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+LiveConfig::~LiveConfig() {
+#ifdef __linux__
+    if (watcher_.joinable()) {
+        const uint64_t stop = 1;
+        if (write(stop_fd_, &stop, sizeof(stop)) != sizeof(stop)) {
+            std::cerr << "error: cannot stop watching configuration " << path_ << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        watcher_.join();
+        close(stop_fd_);
+    }
+#endif
+}
+
+LiveConfig::Reader LiveConfig::Current() const {
+    return Reader(*this);
+}
+
+LiveConfig::ReaderSlot* LiveConfig::AcquireSlot() {
+    ReaderSlot* slot = slots_.load(std::memory_order_acquire);
+    for (bool expected = false; slot != nullptr; slot = slot->next, expected = false) {
+        if (slot->in_use.compare_exchange_strong(expected, true)) {
+            break;
+        }
+    }
+
+    if (slot == nullptr) {
+        slot = new ReaderSlot;
+        slot->in_use.store(true, std::memory_order_relaxed);
+        slot->next = slots_.load(std::memory_order_relaxed);
+        while (!slots_.compare_exchange_weak(slot->next, slot, std::memory_order_release)) {
+        }
+    }
+
+    // Hands the slot back when the thread exits
+    struct Release {
+        ReaderSlot* slot;
+
+        ~Release() {
+            reader_state_.slot = nullptr;
+            slot->in_use.store(false, std::memory_order_release);
+        }
+    };
+    thread_local Release release{slot};
+
+    return slot;
+}
+
+bool LiveConfig::RegisterMembarrier() {
+#if defined(__linux__) && defined(SYS_membarrier)
+    static const bool registered = syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+
+    return registered;
+#else
+    return false;
+#endif
+}
+
+void LiveConfig::WaitForReaders() {
+    // Pairs with the fence of every reader: a reader that still loaded the replaced parser has its slot marked
+    // by now, and a reader that sees the new generation also sees the new parser
+#if defined(__linux__) && defined(SYS_membarrier)
+    if (membarrier_) {
+        syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+#else
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+
+    const uint64_t generation = generation_.fetch_add(1) + 1;
+
+    for (ReaderSlot* slot = slots_.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+        for (uint64_t seen = slot->generation.load(std::memory_order_acquire); seen != 0 && seen < generation;
+             seen = slot->generation.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool LiveConfig::Reload() {
+    // Reloads are serialized, so that a slow reload can never publish older contents over a newer one
+    std::lock_guard lock(reload_mutex_);
+
+    std::ifstream file(path_);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<std::string> tokens = {name_};
+    for (std::string line; std::getline(file, line);) {
+        if (line.starts_with('#')) {
+            continue;
+        }
+        std::istringstream words(line);
+        for (std::string word; words >> word;) {
+            tokens.push_back(std::move(word));
+        }
+    }
+
+    auto parser = std::make_unique<ArgParser>(name_);
+    schema_(*parser);
+    // Published parsers are read concurrently, so no value may be left to convert on first read
+    parser->SetLazy(false);
+
+    // Parse stops the program on malformed input, so every value is converted through the event stream first
+    for (const ParseEvent& event : ParseEvents(*parser, tokens)) {
+        if (!event.HasValidValue()) {
+            return false;
+        }
+    }
+
+    if (!parser->Parse(tokens)) {
+        return false;
+    }
+
+    current_.store(parser.get(), std::memory_order_release);
+    WaitForReaders();
+    current_owner_ = std::move(parser);
+
+    return true;
+}
+
+bool LiveConfig::Watch() {
+#ifdef __linux__
+    if (watcher_.joinable()) {
+        return true;
+    }
+
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0) {
+        return false;
+    }
+
+    watcher_ = std::thread(&LiveConfig::WatchLoop, this);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void LiveConfig::WatchLoop() {
+#ifdef __linux__
+    const int inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        return;
+    }
+
+    // Editors usually replace the file by renaming a new one over it, so the directory is watched
+    const std::filesystem::path path = std::filesystem::absolute(path_);
+    const std::string file_name = path.filename().string();
+    inotify_add_watch(inotify_fd, path.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    alignas(inotify_event) char buffer[4096];
+
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if ((fds[1].revents & POLLIN) != 0) {
+            break;
+        }
+
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        const ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        bool changed = false;
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len != 0 && file_name == event->name) {
+                changed = true;
+            }
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+
+        if (changed) {
+            Reload();
+        }
+    }
+
+    close(inotify_fd);
+#endif
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "arg_parser.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace ArgumentParser {
+
+// Configuration file parsed with an ArgParser schema and reloaded while the program runs.
+// The file holds command line tokens separated by whitespace, lines starting with '#' are skipped.
+// Every successful reload publishes a new immutable parser with an atomic pointer store. Readers never write shared
+// state: each thread marks its own slot with the reload generation it started reading in and then loads the pointer.
+// A reload bumps the generation and waits until no slot holds an older one before freeing the replaced parser, so at
+// most one old parser is alive. On Linux the reloader issues the memory barrier for all readers with membarrier,
+// elsewhere every reader pays for a fence
+class LiveConfig {
+  public:
+    // Keeps the parser that was current when it was created alive. A reload waits for the Readers of every
+    // LiveConfig, so a thread must not hold one while it calls Reload. A Reader must be destroyed by the thread
+    // that created it
+    class Reader {
+      public:
+        explicit Reader(const LiveConfig& config) : parser_(config.Enter()) {}
+
+        ~Reader() {
+            Exit();
+        }
+
+        Reader(const Reader&) = delete;
+
+        Reader& operator=(const Reader&) = delete;
+
+        const ArgParser& operator*() const {
+            return *parser_;
+        }
+
+        const ArgParser* operator->() const {
+            return parser_;
+        }
+
+      private:
+        const ArgParser* parser_;
+    };
+
+    template<typename T>
+    class Handle {
+      public:
+        T Get() const {
+            const Reader reader(*config_);
+
+            return static_cast<const Argument<T>&>(*reader->arguments_[index_]).GetValue();
+        }
+
+      private:
+        friend class LiveConfig;
+
+        Handle(const LiveConfig* config, size_t index) : config_(config), index_(index) {}
+
+        const LiveConfig* config_;
+        size_t index_;
+    };
+
+    LiveConfig(std::string name, std::function<void(ArgParser&)> schema, std::string path);
+
+    ~LiveConfig();
+
+    LiveConfig(const LiveConfig&) = delete;
+
+    LiveConfig& operator=(const LiveConfig&) = delete;
+
+    // Re-reads the file, the current values are kept if the file cannot be read or does not match the schema
+    bool Reload();
+
+    // Starts a thread which reloads the file whenever it is written or replaced, returns false if watching is
+    // not supported on this platform
+    bool Watch();
+
+    // Handle for reading one argument from the latest snapshot without any lookup
+    template<typename T>
+    Handle<T> GetHandle(const std::string& long_name) const {
+        const Reader parser(*this);
+
+        for (size_t i = 0; i < parser->arguments_.size(); ++i) {
+            const ArgumentBase& argument = *parser->arguments_[i];
+
+            if (argument.long_name_ == long_name) {
+                if (argument.GetType() != typeid(T) || argument.IsMultivalued()) {
+                    argument.PrintError(InvalidArgumentType);
+                }
+
+                return Handle<T>(this, i);
+            }
+        }
+
+        ArgParser::PrintError(UnknownArgument, long_name);
+
+        return Handle<T>(this, 0);
+    }
+
+    [[nodiscard]] Reader Current() const;
+
+  private:
+    // Slot of one thread in the process wide list of readers. Slots are never freed, the slot of an exited thread
+    // is reused by the next thread that starts reading
+    struct alignas(64) ReaderSlot {
+        // Reload generation seen when the thread started reading, 0 while it does not read
+        std::atomic<uint64_t> generation = 0;
+        std::atomic<bool> in_use = false;
+        ReaderSlot* next = nullptr;
+    };
+
+    struct ReaderState {
+        ReaderSlot* slot;
+        // Readers nest, only the outermost one marks the slot
+        size_t depth;
+    };
+
+    const ArgParser* Enter() const {
+        ReaderState& state = reader_state_;
+
+        if (state.depth++ == 0) {
+            if (state.slot == nullptr) {
+                state.slot = AcquireSlot();
+            }
+            state.slot->generation.store(generation_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+            // Orders the slot store before the pointer load, with membarrier the reloader does it for the reader
+            if (membarrier_) {
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            } else {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        return current_.load(std::memory_order_acquire);
+    }
+
+    static void Exit() {
+        ReaderState& state = reader_state_;
+
+        if (--state.depth == 0) {
+            state.slot->generation.store(0, std::memory_order_release);
+        }
+    }
+
+    static ReaderSlot* AcquireSlot();
+
+    // Registers the process for expedited membarrier once, returns false if it is not supported
+    static bool RegisterMembarrier();
+
+    void WatchLoop();
+
+    const std::string name_;
+    const std::function<void(ArgParser&)> schema_;
+    const std::string path_;
+
+    // Waits until no reader can still see a parser replaced before the call
+    void WaitForReaders();
+
+    std::atomic<const ArgParser*> current_ = nullptr;
+    std::unique_ptr<ArgParser> current_owner_;
+
+    const bool membarrier_ = RegisterMembarrier();
+
+    static inline std::atomic<uint64_t> generation_ = 1;
+    static inline std::atomic<ReaderSlot*> slots_ = nullptr;
+    static inline thread_local constinit ReaderState reader_state_{};
+
+    std::mutex reload_mutex_;
+
+    std::thread watcher_;
+    int stop_fd_ = -1;
+};
+
+} // ArgumentParser
@@ -0,0 +1,123 @@
+#include "parse_cache.h"
+
+using namespace ArgumentParser;
+
+ParseCache::ParseCache(size_t capacity, size_t shard_count)
+    : shard_capacity_(std::max<size_t>(1, (capacity + shard_count - 1) / std::max<size_t>(1, shard_count))),
+      shards_(std::max<size_t>(1, shard_count)) {}
+
+uint64_t ParseCache::Key(uint64_t schema_hash, const std::vector<std::string>& vec) {
+    uint64_t key = schema_hash;
+    for (const std::string& token : vec) {
+        key ^= std::hash<std::string_view>{}(token) + 0x9e3779b97f4a7c15ull + (key << 6) + (key >> 2);
+    }
+
+    return key;
+}
+
+bool ParseCache::Parse(ArgParser& parser, const std::vector<std::string>& vec) {
+    // Saving the values of a lazy parser converts them, which exits on a bad value the parse would not report
+    if (parser.lazy_) {
+        return parser.Parse(vec);
+    }
+
+    const uint64_t key = Key(parser.ParseHash(), vec);
+    Shard& shard = shards_[key % shards_.size()];
+
+    if (std::shared_ptr<const std::string> values = Find(shard, key, vec)) {
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+
+        SnapshotReader reader(*values);
+        for (const auto& arg : parser.arguments_) {
+            if (!arg->LoadValue(reader)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+
+    if (!parser.Parse(vec)) {
+        return false;
+    }
+
+    // Values are stored in registration order, which the parse hash in the key pins down
+    std::string values;
+    SnapshotWriter writer(values);
+    for (const auto& arg : parser.arguments_) {
+        arg->SaveValue(writer);
+    }
+
+    Insert(shard, key, vec, std::make_shared<const std::string>(std::move(values)));
+
+    return true;
+}
+
+bool ParseCache::Parse(ArgParser& parser, int argc, char** argv) {
+    std::vector<std::string> vec(argc);
+    for (int i = 0; i < argc; ++i) {
+        vec[i] = *(argv + i);
+    }
+    return Parse(parser, vec);
+}
+
+std::shared_ptr<const std::string> ParseCache::Find(Shard& shard, uint64_t key, const std::vector<std::string>& vec) {
+    std::lock_guard lock(shard.mutex);
+
+    auto iter = shard.index.find(key);
+    if (iter == shard.index.end() || iter->second->tokens != vec) {
+        return nullptr;
+    }
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+
+    return iter->second->values;
+}
+
+void ParseCache::Insert(Shard& shard, uint64_t key, const std::vector<std::string>& vec,
+                        std::shared_ptr<const std::string> values) {
+    std::lock_guard lock(shard.mutex);
+
+    // A colliding entry or one inserted by a concurrent miss is replaced
+    auto iter = shard.index.find(key);
+    if (iter != shard.index.end()) {
+        shard.entries.erase(iter->second);
+        shard.index.erase(iter);
+    } else if (shard.entries.size() == shard_capacity_) {
+        shard.index.erase(shard.entries.back().key);
+        shard.entries.pop_back();
+    }
+
+    shard.entries.push_front(Entry{key, vec, std::move(values)});
+    shard.index.emplace(key, shard.entries.begin());
+}
+
+uint64_t ParseCache::GetHits() const {
+    uint64_t hits = 0;
+    for (const Shard& shard : shards_) {
+        hits += shard.hits.load(std::memory_order_relaxed);
+    }
+
+    return hits;
+}
+
+uint64_t ParseCache::GetMisses() const {
+    uint64_t misses = 0;
+    for (const Shard& shard : shards_) {
+        misses += shard.misses.load(std::memory_order_relaxed);
+    }
+
+    return misses;
+}
+
+size_t ParseCache::Size() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard lock(shard.mutex);
+        size += shard.entries.size();
+    }
+
+    return size;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "arg_parser.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ArgumentParser {
+
+// Bounded cache of parse results shared between parsers of the same schema, for programs which parse the same
+// command lines over and over. A result is stored as an immutable blob of the converted values, so a hit skips
+// tokenizing and converting and only restores the values. Entries are spread over independently locked shards by
+// the hash of the tokens, each shard evicts its least recently used entry when full.
+// Entries are keyed on the tokens and on every setting that affects parsing: argument names, types and sizes,
+// positional, eager and delimiter settings, choice tables, lazy mode and constraints
+class ParseCache {
+  public:
+    explicit ParseCache(size_t capacity, size_t shard_count = 16);
+
+    ParseCache(const ParseCache&) = delete;
+
+    ParseCache& operator=(const ParseCache&) = delete;
+
+    // Same as parser.Parse(vec), the values of a successful parse are reused by later calls with equal tokens
+    // and the same schema. Failed parses are not cached. Lazy parsers bypass the cache, and only explicitly parsed
+    // values are cached, so bound targets keep their own defaults on a hit
+    bool Parse(ArgParser& parser, const std::vector<std::string>& vec);
+
+    bool Parse(ArgParser& parser, int argc, char** argv);
+
+    [[nodiscard]] uint64_t GetHits() const;
+
+    [[nodiscard]] uint64_t GetMisses() const;
+
+    [[nodiscard]] size_t Size() const;
+
+  private:
+    struct Entry {
+        uint64_t key;
+        std::vector<std::string> tokens;
+        // Converted values of all arguments in the snapshot encoding, shared with readers
+        std::shared_ptr<const std::string> values;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        // Front is the most recently used entry
+        std::list<Entry> entries;
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        std::atomic<uint64_t> hits = 0;
+        std::atomic<uint64_t> misses = 0;
+    };
+
+    static uint64_t Key(uint64_t schema_hash, const std::vector<std::string>& vec);
+
+    std::shared_ptr<const std::string> Find(Shard& shard, uint64_t key, const std::vector<std::string>& vec);
+
+    void Insert(Shard& shard, uint64_t key, const std::vector<std::string>& vec,
+                std::shared_ptr<const std::string> values);
+
+    const size_t shard_capacity_;
+    std::vector<Shard> shards_;
+};
+
+} // ArgumentParser
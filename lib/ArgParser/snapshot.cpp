@@ -0,0 +1,173 @@
+#include "arg_parser.h"
+
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ArgumentParser;
+
+namespace {
+
+constexpr char kSnapshotMagic[4] = {'A', 'P', 'S', 'N'};
+constexpr uint32_t kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t schema_hash;
+};
+
+uint64_t HashBytes(uint64_t hash, const void* bytes, size_t size) {
+    const auto* data = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+} // namespace
+
+std::vector<ArgumentBase*> ArgParser::SortedArguments() const {
+    std::vector<ArgumentBase*> arguments;
+    arguments.reserve(arguments_.size());
+    for (const auto& arg : arguments_) {
+        arguments.push_back(arg.get());
+    }
+
+    std::sort(arguments.begin(), arguments.end(), [](const ArgumentBase* lhs, const ArgumentBase* rhs) {
+        return lhs->long_name_ < rhs->long_name_;
+    });
+
+    return arguments;
+}
+
+uint64_t ArgParser::SchemaHash() const {
+    uint64_t hash = 14695981039346656037ull;
+
+    for (const ArgumentBase* arg : SortedArguments()) {
+        hash = HashArgument(hash, *arg);
+    }
+
+    return hash;
+}
+
+uint64_t ArgParser::ParseHash() const {
+    uint64_t hash = HashBytes(layout_hash_, &lazy_, sizeof(lazy_));
+
+    for (const auto& arg : arguments_) {
+        const char settings[] = {arg->is_positional_, arg->is_eager_, arg->delimiter_};
+        const void* choices = arg->ChoicesTable();
+
+        hash = HashBytes(hash, settings, sizeof(settings));
+        hash = HashBytes(hash, &choices, sizeof(choices));
+    }
+
+    return constraints_.Hash(hash);
+}
+
+uint64_t ArgParser::HashArgument(uint64_t hash, const ArgumentBase& argument) {
+    const char short_name = argument.short_name_.value_or('\0');
+    const bool multivalued = argument.IsMultivalued();
+    const size_t min_size = argument.MinSize();
+    const std::string_view type_name = argument.GetType().name();
+    // Names are views into the string table and are not terminated, so each string is hashed with its length
+    const size_t name_size = argument.long_name_.size();
+    const size_t type_name_size = type_name.size();
+
+    hash = HashBytes(hash, &name_size, sizeof(name_size));
+    hash = HashBytes(hash, argument.long_name_.data(), name_size);
+    hash = HashBytes(hash, &short_name, sizeof(short_name));
+    hash = HashBytes(hash, &type_name_size, sizeof(type_name_size));
+    hash = HashBytes(hash, type_name.data(), type_name_size);
+    hash = HashBytes(hash, &multivalued, sizeof(multivalued));
+    hash = HashBytes(hash, &min_size, sizeof(min_size));
+
+    return hash;
+}
+
+std::string ArgParser::Snapshot() const {
+    std::string blob;
+    SnapshotWriter writer(blob);
+
+    SnapshotHeader header{};
+    std::copy(std::begin(kSnapshotMagic), std::end(kSnapshotMagic), header.magic);
+    header.version = kSnapshotVersion;
+    header.schema_hash = SchemaHash();
+    writer.Write(&header, sizeof(header));
+
+    for (const ArgumentBase* arg : SortedArguments()) {
+        arg->SaveValue(writer);
+    }
+
+    return blob;
+}
+
+bool ArgParser::LoadSnapshot(std::string_view blob) {
+    SnapshotReader reader(blob);
+
+    SnapshotHeader header{};
+    if (!reader.Read(&header, sizeof(header))
+        || !std::equal(std::begin(kSnapshotMagic), std::end(kSnapshotMagic), header.magic)
+        || header.version != kSnapshotVersion
+        || header.schema_hash != SchemaHash()) {
+        return false;
+    }
+
+    const std::vector<ArgumentBase*> arguments = SortedArguments();
+
+    // The whole body is checked first, so a malformed blob leaves every argument untouched
+    SnapshotReader check = reader;
+    for (const ArgumentBase* arg : arguments) {
+        if (!arg->SkipValue(check)) {
+            return false;
+        }
+    }
+
+    if (!check.Empty()) {
+        return false;
+    }
+
+    for (ArgumentBase* arg : arguments) {
+        if (!arg->LoadValue(reader)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ArgParser::WriteSnapshot(int fd) const {
+    const std::string blob = Snapshot();
+
+    for (size_t written = 0; written < blob.size();) {
+        const ssize_t result = write(fd, blob.data() + written, blob.size() - written);
+        if (result < 0) {
+            return false;
+        }
+        written += result;
+    }
+
+    return true;
+}
+
+bool ArgParser::ReadSnapshot(int fd) {
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        return false;
+    }
+
+    const auto size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    const bool loaded = LoadSnapshot(std::string_view(static_cast<const char*>(data), size));
+    munmap(data, size);
+
+    return loaded;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ArgumentParser {
+
+// Appends values to a snapshot blob: strings and string views are stored as size + bytes, other trivially copyable
+// values as raw bytes, any other type falls back to its operator<< representation
+class SnapshotWriter {
+  public:
+    explicit SnapshotWriter(std::string& data) : data_(data) {}
+
+    void Write(const void* bytes, size_t size) {
+        data_.append(static_cast<const char*>(bytes), size);
+    }
+
+    template<typename T>
+    void WriteValue(const T& value) {
+        if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>) {
+            const auto size = static_cast<uint32_t>(value.size());
+            Write(&size, sizeof(size));
+            Write(value.data(), value.size());
+        } else if constexpr (std::is_trivially_copyable_v<T>) {
+            Write(&value, sizeof(T));
+        } else if constexpr (requires(std::ostream& stream) { stream << value; }) {
+            std::ostringstream stream;
+            stream << value;
+            WriteValue(stream.str());
+        } else {
+            WriteValue(std::string());
+        }
+    }
+
+  private:
+    std::string& data_;
+};
+
+// Reads values written by SnapshotWriter, every read fails once the blob is exhausted
+class SnapshotReader {
+  public:
+    explicit SnapshotReader(std::string_view data) : data_(data) {}
+
+    bool Read(void* bytes, size_t size) {
+        if (size > data_.size()) {
+            return false;
+        }
+
+        std::memcpy(bytes, data_.data(), size);
+        data_.remove_prefix(size);
+
+        return true;
+    }
+
+    template<typename T>
+    bool ReadValue(T& value) {
+        if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>) {
+            uint32_t size = 0;
+            if (!Read(&size, sizeof(size)) || size > data_.size()) {
+                return false;
+            }
+            // A string_view points into the blob, the argument copies it when the value is stored
+            value = T(data_.data(), size);
+            data_.remove_prefix(size);
+
+            return true;
+        } else if constexpr (std::is_trivially_copyable_v<T>) {
+            return Read(&value, sizeof(T));
+        } else if constexpr (requires(std::istream& stream) { stream >> value; }) {
+            std::string str;
+            if (!ReadValue(str)) {
+                return false;
+            }
+            std::istringstream stream(str);
+            stream >> value;
+
+            return !stream.fail();
+        } else {
+            return false;
+        }
+    }
+
+    [[nodiscard]] bool Empty() const {
+        return data_.empty();
+    }
+
+  private:
+    std::string_view data_;
+};
+
+} // ArgumentParser
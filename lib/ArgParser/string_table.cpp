@@ -0,0 +1,33 @@
+#include "string_table.h"
+
+#include <algorithm>
+
+using namespace ArgumentParser;
+
+std::string_view StringTable::Add(std::string_view str) {
+    if (str.empty()) {
+        return {};
+    }
+
+    if (str.size() > block_free_) {
+        const size_t size = std::max(kBlockSize, str.size());
+        blocks_.push_back(std::make_unique<char[]>(size));
+        block_free_ = size;
+        block_end_ = blocks_.back().get() + size;
+    }
+
+    char* begin = block_end_ - block_free_;
+    std::copy(str.begin(), str.end(), begin);
+    block_free_ -= str.size();
+
+    return {begin, str.size()};
+}
+
+std::string_view InternPool::Intern(std::string_view str) {
+    auto iter = index_.find(str);
+    if (iter != index_.end()) {
+        return *iter;
+    }
+
+    return *index_.insert(strings_.Add(str)).first;
+}
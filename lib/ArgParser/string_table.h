@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace ArgumentParser {
+
+// Append-only storage for argument names and descriptions. Strings are packed into large blocks which never move,
+// so the returned views stay valid for the lifetime of the table
+class StringTable {
+  public:
+    std::string_view Add(std::string_view str);
+
+  private:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_free_ = 0;
+    char* block_end_ = nullptr;
+};
+
+// StringTable which keeps every distinct string once, equal strings get the same view
+class InternPool {
+  public:
+    std::string_view Intern(std::string_view str);
+
+  private:
+    StringTable strings_;
+    std::unordered_set<std::string_view> index_;
+};
+
+} // ArgumentParser
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string_view>
+
+namespace ArgumentParser {
+
+enum class TokenKind {
+    Positional,
+    Long,
+    LongWithValue,
+    ShortCluster,
+    Separator,
+};
+
+// Classifies a command line token by its first two characters, for long options border receives the position of '='
+inline TokenKind ClassifyToken(std::string_view token, size_t& border) {
+    if (token.size() < 2 || token[0] != '-') {
+        return TokenKind::Positional;
+    }
+
+    if (token[1] != '-') {
+        return TokenKind::ShortCluster;
+    }
+
+    if (token.size() == 2) {
+        return TokenKind::Separator;
+    }
+
+    // memchr behind find is vectorized by the standard library
+    border = token.find('=', 2);
+
+    return border == std::string_view::npos ? TokenKind::Long : TokenKind::LongWithValue;
+}
+
+} // ArgumentParser
@@ -1,7 +1,12 @@
 #include <lib/ArgParser/arg_parser.h>
+#include <lib/ArgParser/events.h>
+#include <lib/ArgParser/live_config.h>
+#include <lib/ArgParser/parse_cache.h>
 
 #include <gtest/gtest.h>
+#include <fstream>
 #include <sstream>
+#include <thread>
 
 using namespace ArgumentParser;
 
@@ -195,3 +200,695 @@ TEST(ArgParserTestSuite, HelpStringTest) {
     //     "-h, --help Display this help and exit\n"
     // );
 }
+
+
+struct BindOptions {
+    std::vector<int> values = {42};
+    std::string input;
+    int threads = 4;
+    bool verbose = false;
+};
+
+TEST(ArgParserTestSuite, BindTest) {
+    ArgParser parser("My Parser");
+    BindOptions opt;
+    parser.Bind(opt, &BindOptions::input, 'i', "input");
+    parser.Bind(opt, &BindOptions::threads, "threads");
+    parser.Bind(opt, &BindOptions::verbose, 'v', "verbose");
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -v --input=file --threads=8")));
+    ASSERT_EQ(opt.input, "file");
+    ASSERT_EQ(opt.threads, 8);
+    ASSERT_TRUE(opt.verbose);
+    ASSERT_EQ(parser.GetArgumentValue<int>("threads"), 8);
+}
+
+
+TEST(ArgParserTestSuite, BindDefaultTest) {
+    ArgParser parser("My Parser");
+    BindOptions opt;
+    parser.Bind(opt, &BindOptions::threads, "threads");
+    parser.Bind<1>(opt, &BindOptions::values, "values").Positional();
+
+    const std::string help = parser.HelpDescription();
+    ASSERT_NE(help.find("--threads=<int> [default = 4]"), std::string::npos);
+    ASSERT_NE(help.find("--values=<int> [positional, multivalued (min = 1), default = 42]"), std::string::npos);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app")));
+    ASSERT_EQ(opt.threads, 4);
+    ASSERT_EQ(opt.values, std::vector<int>{42});
+
+    ASSERT_TRUE(parser.Parse(SplitString("app 1 2 3")));
+    ASSERT_EQ(opt.values, std::vector<int>({1, 2, 3}));
+}
+
+
+enum class Mode {
+    Fast,
+    Safe,
+    Bulk,
+};
+
+constexpr ChoiceTable<Mode, 3> kModes({{"fast", Mode::Fast}, {"safe", Mode::Safe}, {"bulk", Mode::Bulk}});
+const ChoiceTable<std::string, 2> kLevels({{"low", "1"}, {"high", "2"}});
+
+TEST(ArgParserTestSuite, ChoiceTest) {
+    ArgParser parser("My Parser");
+    parser.AddArgument<Mode>('m', "mode").Choices(kModes).Default(Mode::Safe);
+    parser.AddArgument<std::string, 1>("level").Choices(kLevels);
+
+    static_assert(*kModes.Find("bulk") == Mode::Bulk);
+    static_assert(kModes.Find("slow") == nullptr);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -m bulk --level=high")));
+    ASSERT_EQ(parser.GetArgumentValue<Mode>("mode"), Mode::Bulk);
+    ASSERT_EQ(parser.GetArgumentValue<std::string>("level", 0), "2");
+}
+
+
+TEST(ArgParserTestSuite, ChoiceHelpTest) {
+    ArgParser parser("My Parser");
+    parser.AddArgument<Mode>("mode").Choices(kModes).Default(Mode::Safe);
+
+    ASSERT_NE(parser.HelpDescription().find("--mode=<fast|safe|bulk> [default = safe]"), std::string::npos);
+}
+
+
+TEST(ArgParserTestSuite, InvalidChoiceTest) {
+    ArgParser parser("My Parser");
+    parser.AddArgument<Mode>("mode").Choices(kModes);
+
+    ASSERT_EXIT(parser.Parse(SplitString("app --mode=slow")), testing::ExitedWithCode(EXIT_FAILURE),
+                "must be one of <fast\\|safe\\|bulk>");
+}
+
+
+void AddSnapshotArguments(ArgParser& parser) {
+    parser.AddArgument<std::string>('i', "input");
+    parser.AddArgument<int, 1>("ids");
+    parser.AddArgument<Mode>("mode").Choices(kModes).Default(Mode::Safe);
+    parser.AddFlag('v', "verbose");
+}
+
+TEST(ArgParserTestSuite, SnapshotTest) {
+    ArgParser parser("My Parser");
+    AddSnapshotArguments(parser);
+    ASSERT_TRUE(parser.Parse(SplitString("app -v --input=file --ids=1 --ids=2 --mode=bulk")));
+
+    ArgParser worker("My Parser");
+    AddSnapshotArguments(worker);
+
+    ASSERT_TRUE(worker.LoadSnapshot(parser.Snapshot()));
+    ASSERT_EQ(worker.GetArgumentValue<std::string>("input"), "file");
+    ASSERT_EQ(worker.GetArgumentValue<int>("ids", 1), 2);
+    ASSERT_EQ(worker.GetArgumentValue<Mode>("mode"), Mode::Bulk);
+    ASSERT_TRUE(worker.GetFlagValue('v'));
+}
+
+
+TEST(ArgParserTestSuite, SnapshotFileTest) {
+    ArgParser parser("My Parser");
+    AddSnapshotArguments(parser);
+    ASSERT_TRUE(parser.Parse(SplitString("app --input=file --ids=7")));
+
+    FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    ASSERT_TRUE(parser.WriteSnapshot(fileno(file)));
+
+    ArgParser worker("My Parser");
+    AddSnapshotArguments(worker);
+
+    ASSERT_TRUE(worker.ReadSnapshot(fileno(file)));
+    ASSERT_EQ(worker.GetArgumentValue<int>("ids", 0), 7);
+    ASSERT_EQ(worker.GetArgumentValue<Mode>("mode"), Mode::Safe);
+    std::fclose(file);
+}
+
+
+TEST(ArgParserTestSuite, SnapshotSchemaMismatchTest) {
+    ArgParser parser("My Parser");
+    AddSnapshotArguments(parser);
+    ASSERT_TRUE(parser.Parse(SplitString("app --input=file --ids=7")));
+
+    ArgParser worker("My Parser");
+    AddSnapshotArguments(worker);
+    worker.AddArgument<int>("threads");
+
+    ASSERT_FALSE(worker.LoadSnapshot(parser.Snapshot()));
+    ASSERT_FALSE(worker.LoadSnapshot(parser.Snapshot().substr(0, 20)));
+}
+
+
+TEST(ArgParserTestSuite, SnapshotDescriptionTest) {
+    ArgParser parser("My Parser");
+    parser.AddArgument<int>("alpha", "first");
+    parser.AddArgument<int>("beta", "one description");
+    ASSERT_TRUE(parser.Parse(SplitString("app --alpha=1 --beta=2")));
+
+    // Descriptions are not part of the schema
+    ArgParser worker("My Parser");
+    worker.AddArgument<int>("alpha", "First");
+    worker.AddArgument<int>("beta", "another description");
+    ASSERT_TRUE(worker.LoadSnapshot(parser.Snapshot()));
+    ASSERT_EQ(worker.GetArgumentValue<int>("beta"), 2);
+
+    // A name filling a whole string table block is hashed without reading past it
+    ArgParser long_names("My Parser");
+    long_names.AddArgument<int>(std::string(65536, 'a'));
+    ASSERT_TRUE(long_names.LoadSnapshot(long_names.Snapshot()));
+}
+
+
+TEST(ArgParserTestSuite, SnapshotReloadTest) {
+    ArgParser parser("My Parser");
+    AddSnapshotArguments(parser);
+    ASSERT_TRUE(parser.Parse(SplitString("app --input=file --ids=1 --ids=2")));
+    const std::string blob = parser.Snapshot();
+
+    ArgParser worker("My Parser");
+    AddSnapshotArguments(worker);
+    ASSERT_TRUE(worker.Parse(SplitString("app -v --input=old --ids=9")));
+
+    // A truncated blob is rejected before any value is replaced
+    ASSERT_FALSE(worker.LoadSnapshot(std::string_view(blob).substr(0, blob.size() - 1)));
+    ASSERT_EQ(worker.GetArgumentValue<std::string>("input"), "old");
+    ASSERT_EQ(worker.GetArgumentValues<int>("ids").size(), 1);
+
+    // Loading replaces the parsed values instead of appending to them
+    ASSERT_TRUE(worker.LoadSnapshot(blob));
+    ASSERT_TRUE(worker.LoadSnapshot(blob));
+    ASSERT_EQ(worker.GetArgumentValue<std::string>("input"), "file");
+    ASSERT_EQ(worker.GetArgumentValues<int>("ids").size(), 2);
+    ASSERT_FALSE(worker.GetFlagValue('v'));
+}
+
+
+TEST(ArgParserTestSuite, SeparatorTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag('v', "verbose");
+    std::vector<std::string>& files = parser.AddArgument<std::string, 1>("files").Positional().GetStorage();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -v a -- --verbose -x -")));
+    ASSERT_EQ(files, std::vector<std::string>({"a", "--verbose", "-x", "-"}));
+}
+
+
+TEST(ArgParserTestSuite, ShortClusterValueTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag('a', "flag1");
+    parser.AddFlag('b', "flag2");
+    parser.AddArgument<int>('n', "number");
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -abn 5")));
+    ASSERT_TRUE(parser.GetFlagValue('a'));
+    ASSERT_TRUE(parser.GetFlagValue('b'));
+    ASSERT_EQ(parser.GetArgumentValue<int>('n'), 5);
+}
+
+
+constexpr OptionSpec kSpecs[] = {
+    {.short_name = 'i', .long_name = "input", .description = "File path for input file", .type = OptionType::String},
+    {.short_name = 'n', .long_name = "number", .description = "Some Number", .type = OptionType::Int,
+     .default_value = "10"},
+    {.short_name = 'v', .long_name = "verbose", .description = "Print more", .type = OptionType::Flag},
+    {.long_name = "values", .type = OptionType::Float, .positional = true, .multivalued = true, .min_size = 1},
+};
+
+TEST(ArgParserTestSuite, AddArgumentsTest) {
+    ArgParser parser("My Parser");
+    parser.AddArguments(kSpecs);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -v --input=file 1.5 2.5")));
+    ASSERT_EQ(parser.GetArgumentValue<std::string>('i'), "file");
+    ASSERT_EQ(parser.GetArgumentValue<int>("number"), 10);
+    ASSERT_TRUE(parser.GetFlagValue("verbose"));
+    ASSERT_EQ(parser.GetArgumentValue<float>("values", 1), 2.5);
+}
+
+
+TEST(ArgParserTestSuite, AddArgumentsDuplicateTest) {
+    constexpr OptionSpec specs[] = {
+        {.short_name = 'a', .long_name = "param1"},
+        {.short_name = 'b', .long_name = "param2"},
+        {.short_name = 'c', .long_name = "param1"},
+    };
+    ArgParser parser("My Parser");
+
+    ASSERT_EXIT(parser.AddArguments(specs), testing::ExitedWithCode(EXIT_FAILURE), "argument --param1 already exists");
+}
+
+
+TEST(ArgParserTestSuite, LazyTest) {
+    ArgParser parser("My Parser");
+    parser.SetLazy();
+    parser.AddArgument<int>("number");
+    parser.AddArgument<SomeStruct>("unused");
+    parser.AddArgument<int, 2>('p', "param1");
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --number=5 --unused=not_a_number -p 1 --param1=2")));
+    ASSERT_EQ(parser.GetArgumentValue<int>("number"), 5);
+    ASSERT_EQ(parser.GetArgumentValue<int>("param1", 1), 2);
+    ASSERT_EXIT(parser.GetArgumentValue<SomeStruct>("unused"), testing::ExitedWithCode(EXIT_FAILURE),
+                "argument --unused has value type");
+}
+
+
+TEST(ArgParserTestSuite, LazyEagerTest) {
+    ArgParser parser("My Parser");
+    parser.SetLazy();
+    parser.AddArgument<int>("number").Eager();
+    int& storage = parser.AddArgument<int>("stored").GetStorage();
+
+    ASSERT_EXIT(parser.Parse(SplitString("app --number=abc")), testing::ExitedWithCode(EXIT_FAILURE),
+                "argument --number has value type <int>");
+    ASSERT_TRUE(parser.Parse(SplitString("app --number=1 --stored=7")));
+    ASSERT_EQ(storage, 7);
+}
+
+
+TEST(ArgParserTestSuite, DelimitedListTest) {
+    ArgParser parser("My Parser");
+    std::vector<int>& ids = parser.AddArgument<int, 4>("ids").Delimiter().GetStorage();
+    parser.AddArgument<std::string, 1>('t', "tags").Delimiter(':');
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --ids=1,2,3 -t a:b --ids=4")));
+    ASSERT_EQ(ids, std::vector<int>({1, 2, 3, 4}));
+    ASSERT_EQ(parser.GetArgumentValue<std::string>("tags", 1), "b");
+}
+
+
+TEST(ArgParserTestSuite, LongDelimitedListTest) {
+    ArgParser parser("My Parser");
+    parser.SetLazy();
+    parser.AddArgument<int, 1000000>("ids").Delimiter();
+
+    std::string list = "--ids=0";
+    for (int i = 1; i < 1000000; ++i) {
+        list += ',' + std::to_string(i);
+    }
+
+    ASSERT_TRUE(parser.Parse({"app", list}));
+    ASSERT_EQ(parser.GetArgumentValue<int>("ids", 999999), 999999);
+}
+
+
+TEST(ArgParserTestSuite, InternedStringTest) {
+    ArgParser parser("My Parser");
+    std::vector<std::string_view>& tags = parser.AddArgument<std::string_view, 1>("tag").Delimiter().GetStorage();
+    {
+        const std::string host = "localhost";
+        parser.AddArgument<std::string_view>("host").Default(host);
+    }
+
+    {
+        std::vector<std::string> args = SplitString("app --tag=red,green --tag=red --tag=green,red");
+        ASSERT_TRUE(parser.Parse(args));
+    }
+
+    ASSERT_EQ(tags, std::vector<std::string_view>({"red", "green", "red", "green", "red"}));
+    ASSERT_EQ(tags[0].data(), tags[2].data());
+    ASSERT_EQ(tags[1].data(), tags[3].data());
+    ASSERT_EQ(parser.GetArgumentValue<std::string_view>("host"), "localhost");
+}
+
+
+TEST(ArgParserTestSuite, ValueAccessTest) {
+    ArgParser parser("My Parser");
+    parser.AddArgument<std::string>('n', "name");
+    parser.AddArgument<int, 1>("ids").Delimiter();
+    parser.AddArgument<float, 1>("N").Positional();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -n value --ids=1,2,3 1.5 2.5")));
+
+    const std::string& name = parser.GetArgumentRef<std::string>("name");
+    ASSERT_EQ(&name, &parser.GetArgumentRef<std::string>('n'));
+    ASSERT_EQ(parser.GetArgumentView("name"), "value");
+
+    std::span<const int> ids = parser.GetArgumentValues<int>("ids");
+    ASSERT_EQ(std::vector<int>(ids.begin(), ids.end()), std::vector<int>({1, 2, 3}));
+
+    const float* data = parser.GetArgumentValues<float>("N").data();
+    std::vector<float> values = parser.Take<std::vector<float>>("N");
+    ASSERT_EQ(values.data(), data);
+    ASSERT_EQ(values, std::vector<float>({1.5, 2.5}));
+    ASSERT_EQ(parser.Take<std::string>("name"), "value");
+
+    ASSERT_EXIT(parser.GetArgumentValues<int>("name"), testing::ExitedWithCode(EXIT_FAILURE),
+                "argument --name has value type <string>");
+}
+
+
+TEST(ArgParserTestSuite, TakeBoundDefaultTest) {
+    ArgParser parser("My Parser");
+    BindOptions opt;
+    opt.values = {7, 8};
+    parser.Bind<1>(opt, &BindOptions::values, "values");
+
+    ASSERT_TRUE(parser.Parse(SplitString("app")));
+    ASSERT_EQ(parser.Take<std::vector<int>>("values"), std::vector<int>({7, 8}));
+}
+
+
+TEST(ArgParserTestSuite, ConstraintTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag("sum");
+    parser.AddFlag("mult");
+    parser.AddFlag('v', "verbose");
+    parser.AddArgument<std::string>("log").Default("stderr");
+    parser.AddArgument<std::string>("output").Default("out.txt");
+
+    parser.MutuallyExclusive({"sum", "mult"});
+    parser.AtLeastOneOf({"sum", "mult"});
+    parser.Requires("log", {"verbose"});
+    parser.ConflictsWith("output", {"verbose"});
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --sum")));
+    ASSERT_TRUE(parser.Parse(SplitString("app --mult -v --log=file")));
+
+    testing::internal::CaptureStderr();
+    ASSERT_FALSE(parser.Parse(SplitString("app --sum --mult --log=file")));
+    ASSERT_EQ(testing::internal::GetCapturedStderr(),
+              "error: arguments --sum, --mult are mutually exclusive\n"
+              "error: argument --log requires --verbose\n");
+
+    testing::internal::CaptureStderr();
+    ASSERT_FALSE(parser.Parse(SplitString("app -v --output=a.txt")));
+    ASSERT_EQ(testing::internal::GetCapturedStderr(),
+              "error: one of the arguments --sum, --mult is required\n"
+              "error: argument --output conflicts with --verbose\n");
+
+    parser.AddHelp();
+    ASSERT_TRUE(parser.Parse(SplitString("app --help --sum --mult")));
+    ASSERT_TRUE(parser.Help());
+}
+
+
+TEST(ArgParserTestSuite, RequiredTest) {
+    ArgParser parser("My Parser");
+    parser.AddArgument<int>("first").Default(1);
+    parser.AddArgument<int>("second").Default(2);
+    for (int i = 0; i < 100; ++i) {
+        parser.AddFlag("flag" + std::to_string(i));
+    }
+    parser.Required("first");
+    parser.Required("second");
+    parser.Required("flag99");
+
+    testing::internal::CaptureStderr();
+    ASSERT_FALSE(parser.Parse(SplitString("app --second=3")));
+    ASSERT_EQ(testing::internal::GetCapturedStderr(), "error: missing required arguments: --first, --flag99\n");
+    ASSERT_TRUE(parser.Parse(SplitString("app --second=3 --first=4 --flag99")));
+}
+
+
+TEST(ArgParserTestSuite, ParseCacheTest) {
+    ParseCache cache(2, 1);
+
+    const auto make_parser = [] {
+        auto parser = std::make_unique<ArgParser>("My Parser");
+        parser->AddArgument<std::string>("queue").Default("default");
+        parser->AddArgument<int, 1>("N").Positional();
+        parser->AddFlag("urgent");
+        return parser;
+    };
+
+    for (int i = 0; i < 3; ++i) {
+        auto parser = make_parser();
+        ASSERT_TRUE(cache.Parse(*parser, SplitString("app --queue=fast --urgent 1 2 3")));
+        ASSERT_EQ(parser->GetArgumentValue<std::string>("queue"), "fast");
+        ASSERT_TRUE(parser->GetFlagValue("urgent"));
+        ASSERT_EQ(parser->Take<std::vector<int>>("N"), std::vector<int>({1, 2, 3}));
+    }
+    ASSERT_EQ(cache.GetHits(), 2);
+    ASSERT_EQ(cache.GetMisses(), 1);
+
+    // Failed parses are not cached
+    ASSERT_FALSE(cache.Parse(*make_parser(), SplitString("app --queue=slow")));
+    ASSERT_EQ(cache.Size(), 1);
+
+    ASSERT_TRUE(cache.Parse(*make_parser(), SplitString("app 1")));
+    ASSERT_TRUE(cache.Parse(*make_parser(), SplitString("app 2")));
+    ASSERT_EQ(cache.Size(), 2);
+
+    // Another schema never shares entries with the first one
+    ArgParser other("My Parser");
+    other.AddArgument<int, 1>("N").Positional();
+    ASSERT_TRUE(cache.Parse(other, SplitString("app 2")));
+    ASSERT_EQ(cache.GetHits(), 2);
+    ASSERT_EQ(cache.GetMisses(), 5);
+
+    // Bound targets keep their own defaults on a hit, only parsed values come from the cache
+    struct Options {
+        int threads;
+        std::vector<int> ids;
+        std::string queue;
+    };
+    const auto make_bound_parser = [](Options& opt) {
+        auto parser = std::make_unique<ArgParser>("My Parser");
+        parser->AddArgument<int>("threads").Bind(opt.threads);
+        parser->AddArgument<int, 1>("ids").Bind(opt.ids);
+        parser->AddArgument<std::string>("queue").Bind(opt.queue);
+        return parser;
+    };
+
+    ParseCache bound_cache(4);
+    Options first{4, {1}, "default"};
+    ASSERT_TRUE(bound_cache.Parse(*make_bound_parser(first), SplitString("app --queue=fast")));
+    Options second{8, {5, 6}, "slow"};
+    ASSERT_TRUE(bound_cache.Parse(*make_bound_parser(second), SplitString("app --queue=fast")));
+    ASSERT_EQ(bound_cache.GetHits(), 1);
+    ASSERT_EQ(second.threads, 8);
+    ASSERT_EQ(second.ids, std::vector<int>({5, 6}));
+    ASSERT_EQ(second.queue, "fast");
+
+    // Lazy parsers are not cached
+    ArgParser lazy("My Parser");
+    lazy.SetLazy();
+    lazy.AddArgument<int>("threads");
+    ASSERT_TRUE(bound_cache.Parse(lazy, SplitString("app --threads=2")));
+    ASSERT_EQ(bound_cache.Size(), 1);
+}
+
+
+TEST(ArgParserTestSuite, ParseCacheSchemaTest) {
+    ParseCache cache(16);
+
+    ArgParser plain("My Parser");
+    plain.AddFlag("x");
+    plain.AddFlag("y");
+    ASSERT_TRUE(cache.Parse(plain, SplitString("app --x --y")));
+
+    // Constraints are part of the key, so the entry of the plain parser is not reused
+    ArgParser exclusive("My Parser");
+    exclusive.AddFlag("x");
+    exclusive.AddFlag("y");
+    exclusive.MutuallyExclusive({"x", "y"});
+    testing::internal::CaptureStderr();
+    ASSERT_FALSE(cache.Parse(exclusive, SplitString("app --x --y")));
+    ASSERT_EQ(testing::internal::GetCapturedStderr(), "error: arguments --x, --y are mutually exclusive\n");
+
+    ArgParser positional("My Parser");
+    positional.AddArgument<int, 1>("N").Positional();
+    ASSERT_TRUE(cache.Parse(positional, SplitString("app 1")));
+
+    ArgParser named("My Parser");
+    named.AddArgument<int, 1>("N");
+    ASSERT_EXIT(cache.Parse(named, SplitString("app 1")), testing::ExitedWithCode(EXIT_FAILURE),
+                "no positional argument for the value 1");
+
+    ArgParser delimited("My Parser");
+    delimited.AddArgument<int, 1>("N").Positional().Delimiter();
+    ASSERT_TRUE(cache.Parse(delimited, SplitString("app 1")));
+    ASSERT_EQ(cache.GetHits(), 0);
+}
+
+
+TEST(ArgParserTestSuite, ParseCacheConcurrentTest) {
+    ParseCache cache(64);
+    std::atomic<bool> failed = false;
+    std::vector<std::thread> threads;
+
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                ArgParser parser("My Parser");
+                parser.AddArgument<int>("value");
+                if (!cache.Parse(parser, {"app", "--value=" + std::to_string(i % 100)})
+                    || parser.GetArgumentValue<int>("value") != i % 100) {
+                    failed = true;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_FALSE(failed);
+    ASSERT_EQ(cache.GetHits() + cache.GetMisses(), 4000);
+    ASSERT_LE(cache.Size(), 64);
+}
+
+
+TEST(ArgParserTestSuite, EventsTest) {
+    ArgParser parser("My Parser");
+    parser.AddArgument<std::string, 1>('i', "input");
+    parser.AddArgument<int>("filter");
+    parser.AddArgument<int, 1>("ids").Delimiter();
+    parser.AddFlag('v', "verbose");
+
+    const std::vector<std::string> args = SplitString("app --input=a -v --filter=5 -i b --ids=1,2 c --unknown");
+    std::vector<std::string> order;
+    int sum = 0;
+
+    for (const ParseEvent& event : ParseEvents(parser, args)) {
+        switch (event.GetKind()) {
+            case EventKind::Option:
+                order.emplace_back(event.GetLongName());
+                if (event.GetLongName() == "ids" || event.GetLongName() == "filter") {
+                    sum += event.GetValue<int>();
+                }
+                break;
+            case EventKind::Positional:
+                ASSERT_EQ(event.GetArgument(), nullptr);
+                order.emplace_back(event.GetToken());
+                break;
+            case EventKind::Error:
+                ASSERT_EQ(event.GetError(), UnknownArgument);
+                order.emplace_back("error");
+                break;
+        }
+    }
+
+    ASSERT_EQ(order, std::vector<std::string>({"input", "verbose", "filter", "input", "ids", "ids", "c", "error"}));
+    ASSERT_EQ(sum, 8);
+    ASSERT_FALSE(parser.Parse(SplitString("app")));
+}
+
+
+void WriteConfig(const std::string& path, const std::string& content) {
+    const std::string temporary = path + ".tmp";
+    std::ofstream(temporary) << content;
+    std::rename(temporary.c_str(), path.c_str());
+}
+
+void AddLiveSchema(ArgParser& parser) {
+    parser.AddArgument<int>("max-inflight").Default(1);
+    parser.AddArgument<Mode>("mode").Choices(kModes).Default(Mode::Safe);
+}
+
+TEST(ArgParserTestSuite, LiveConfigReloadTest) {
+    const std::string path = testing::TempDir() + "live_config_reload.conf";
+    WriteConfig(path, "# tunables\n--max-inflight=8\n");
+
+    LiveConfig config("My Parser", AddLiveSchema, path);
+    auto max_inflight = config.GetHandle<int>("max-inflight");
+    auto mode = config.GetHandle<Mode>("mode");
+
+    ASSERT_EQ(max_inflight.Get(), 8);
+    ASSERT_EQ(mode.Get(), Mode::Safe);
+
+    WriteConfig(path, "--max-inflight=16 --mode=bulk");
+    ASSERT_TRUE(config.Reload());
+    ASSERT_EQ(max_inflight.Get(), 16);
+    ASSERT_EQ(mode.Get(), Mode::Bulk);
+
+    WriteConfig(path, "--max-inflight=32 --unknown=1");
+    ASSERT_FALSE(config.Reload());
+    ASSERT_EQ(max_inflight.Get(), 16);
+
+    // Values that do not convert are rejected without stopping the program
+    WriteConfig(path, "--max-inflight=abc");
+    ASSERT_FALSE(config.Reload());
+    WriteConfig(path, "--max-inflight=32 --mode=turbo");
+    ASSERT_FALSE(config.Reload());
+    ASSERT_EQ(max_inflight.Get(), 16);
+    ASSERT_EQ(mode.Get(), Mode::Bulk);
+
+    // Lazy schemas are parsed eagerly, readers never convert values of a published parser
+    const auto lazy_schema = [](ArgParser& parser) {
+        parser.SetLazy();
+        AddLiveSchema(parser);
+    };
+    WriteConfig(path, "--max-inflight=64");
+    LiveConfig lazy("My Parser", lazy_schema, path);
+    ASSERT_EQ(lazy.GetHandle<int>("max-inflight").Get(), 64);
+}
+
+
+TEST(ArgParserTestSuite, LiveConfigReclaimTest) {
+    const std::string path = testing::TempDir() + "live_config_reclaim.conf";
+    WriteConfig(path, "--max-inflight=1");
+
+    LiveConfig config("My Parser", AddLiveSchema, path);
+    auto max_inflight = config.GetHandle<int>("max-inflight");
+    std::atomic<bool> reloaded = false;
+    std::thread reloader;
+
+    {
+        const LiveConfig::Reader reader = config.Current();
+        const std::string help = reader->HelpDescription();
+
+        WriteConfig(path, "--max-inflight=2");
+        reloader = std::thread([&] {
+            reloaded = config.Reload();
+        });
+
+        // The new value is visible at once, but the old parser is only freed after its reader is gone
+        while (max_inflight.Get() != 2) {
+            std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        EXPECT_FALSE(reloaded);
+        EXPECT_EQ(reader->HelpDescription(), help);
+    }
+
+    reloader.join();
+    ASSERT_TRUE(reloaded);
+}
+
+
+TEST(ArgParserTestSuite, LiveConfigStressTest) {
+    const std::string path = testing::TempDir() + "live_config_stress.conf";
+    WriteConfig(path, "--max-inflight=0");
+
+    LiveConfig config("My Parser", AddLiveSchema, path);
+    auto max_inflight = config.GetHandle<int>("max-inflight");
+    ASSERT_TRUE(config.Watch());
+
+    constexpr int kLastValue = 50;
+    std::atomic<bool> failed = false;
+    std::vector<std::thread> readers;
+
+    for (int i = 0; i < 8; ++i) {
+        readers.emplace_back([&] {
+            int previous = 0;
+            while (previous != kLastValue) {
+                const int current = max_inflight.Get();
+                if (current < previous || current > kLastValue) {
+                    failed = true;
+                    return;
+                }
+                previous = current;
+            }
+        });
+    }
+
+    for (int value = 1; value <= kLastValue; ++value) {
+        WriteConfig(path, "--max-inflight=" + std::to_string(value));
+        if (value % 10 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // The watcher may coalesce writes, the last value is published explicitly so that readers always finish
+    ASSERT_TRUE(config.Reload());
+
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    ASSERT_FALSE(failed);
+    ASSERT_EQ(max_inflight.Get(), kLastValue);
+}